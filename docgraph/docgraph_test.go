@@ -109,6 +109,69 @@ func TestGetLastDocOfEdgeName(t *testing.T) {
 	assert.Equal(t, randomDoc2.Hash.String(), lastDocument.Hash.String())
 }
 
+func TestApplyBatch(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	existing, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	removed, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], existing.Hash, removed.Hash, "test")
+	assert.NilError(t, err)
+
+	member, assignment := uint32(0), uint32(1)
+	operations := []docgraph.GraphOperation{
+		{Type: "create", Creator: eos.Name(env.Creators[1]), ContentGroups: randomContentGroups()},
+		{Type: "create", Creator: eos.Name(env.Creators[1]), ContentGroups: randomContentGroups()},
+		{Type: "newedge", Creator: eos.Name(env.Creators[1]), FromOp: &member, ToOp: &assignment, EdgeName: "assigned"},
+		{Type: "newedge", Creator: eos.Name(env.Creators[1]), FromOp: &assignment, ToNode: existing.Hash, EdgeName: "test"},
+		{Type: "removeedge", FromNode: existing.Hash, ToNode: removed.Hash, EdgeName: "test"},
+		{Type: "erase", FromNode: removed.Hash},
+	}
+	_, err = docgraph.ApplyBatch(env.ctx, &env.api, env.Docs, env.Creators[1], operations)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	// the edge to an existing document comes from the second created document
+	edges, err := docgraph.GetEdgesToDocumentWithEdge(env.ctx, &env.api, env.Docs, existing, "test")
+	assert.NilError(t, err)
+	assert.Equal(t, len(edges), 1)
+
+	assignmentDoc, err := docgraph.LoadDocument(env.ctx, &env.api, env.Docs, edges[0].FromNode.String())
+	assert.NilError(t, err)
+
+	edges, err = docgraph.GetEdgesToDocumentWithEdge(env.ctx, &env.api, env.Docs, assignmentDoc, "assigned")
+	assert.NilError(t, err)
+	assert.Equal(t, len(edges), 1)
+
+	_, err = docgraph.LoadDocument(env.ctx, &env.api, env.Docs, removed.Hash.String())
+	assert.ErrorContains(t, err, "document not found")
+
+	allEdges, err := docgraph.GetAllEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(allEdges), 2)
+
+	// a failing operation reverts the whole batch
+	operations = []docgraph.GraphOperation{
+		{Type: "create", Creator: eos.Name(env.Creators[1]), ContentGroups: randomContentGroups()},
+		{Type: "newedge", Creator: eos.Name(env.Creators[1]), FromOp: &member, ToNode: removed.Hash, EdgeName: "test"},
+		{Type: "erase", FromNode: removed.Hash},
+	}
+	_, err = docgraph.ApplyBatch(env.ctx, &env.api, env.Docs, env.Creators[1], operations)
+	assert.ErrorContains(t, err, "does not exist")
+
+	allEdges, err = docgraph.GetAllEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(allEdges), 2)
+}
+
 func TestManyDocuments(t *testing.T) {
 	teardownTestCase := setupTestCase(t)
 	defer teardownTestCase(t)
@@ -25,7 +25,7 @@ func (c *ContentNotFoundError) Error() string {
 // Document is a node in the document graph
 // A document may hold any arbitrary, EOSIO compatible data
 type Document struct {
-	ID            uint64          `json:"id"`
+	ID            eos.Uint64      `json:"id"`
 	Hash          eos.Checksum256 `json:"hash"`
 	Creator       eos.AccountName `json:"creator"`
 	ContentGroups []ContentGroup  `json:"content_groups"`
@@ -35,6 +35,11 @@ type Document struct {
 		CertificationDate eos.BlockTimestamp `json:"certification_date"`
 	} `json:"certificates"`
 	CreatedDate eos.BlockTimestamp `json:"created_date"`
+	// set when the content groups are kept in the docgroups table
+	GroupKeys []eos.Uint64 `json:"group_keys,omitempty"`
+	// 0 or 1 for the flat hash, 2 for the Merkle hash over GroupHashes
+	HashVersion uint8             `json:"hash_version,omitempty"`
+	GroupHashes []eos.Checksum256 `json:"group_hashes,omitempty"`
 }
 
 func newDocumentTrx(ctx context.Context, api *eos.API,
@@ -228,9 +233,119 @@ func LoadDocument(ctx context.Context, api *eos.API,
 	if len(documents) == 0 {
 		return Document{}, fmt.Errorf("document not found %v: %v", hash, err)
 	}
+
+	err = documents[0].loadGroups(ctx, api, contract)
+	if err != nil {
+		return Document{}, err
+	}
 	return documents[0], nil
 }
 
+// DocumentKeyState is the dockeys singleton, which tracks how document primary keys are
+// assigned; KeyVersion 2 without Migrating means every row has a hash-derived key
+type DocumentKeyState struct {
+	KeyVersion uint8      `json:"key_version"`
+	Migrating  bool       `json:"migrating"`
+	Cursor     eos.Uint64 `json:"cursor"`
+}
+
+// GetDocumentKeyState reads the dockeys singleton, which is unset until the first migdockeys
+func GetDocumentKeyState(ctx context.Context, api *eos.API, contract eos.AccountName) (DocumentKeyState, error) {
+	var states []DocumentKeyState
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "dockeys"
+	request.Limit = 1
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return DocumentKeyState{}, fmt.Errorf("get table rows %v", err)
+	}
+
+	err = response.JSONToStructs(&states)
+	if err != nil {
+		return DocumentKeyState{}, fmt.Errorf("json to structs %v", err)
+	}
+
+	if len(states) == 0 {
+		return DocumentKeyState{KeyVersion: 1}, nil
+	}
+	return states[0], nil
+}
+
+// DocumentAuditState is the docaudit singleton, the progress and findings of the auditdocs
+// pass that recomputes stored document hashes
+type DocumentAuditState struct {
+	Running      bool            `json:"running"`
+	Cursor       eos.Uint64      `json:"cursor"`
+	Checked      eos.Uint64      `json:"checked"`
+	Mismatches   eos.Uint64      `json:"mismatches"`
+	LastMismatch eos.Checksum256 `json:"last_mismatch"`
+}
+
+// GetDocumentAuditState reads the docaudit singleton, which is unset until the first auditdocs
+func GetDocumentAuditState(ctx context.Context, api *eos.API, contract eos.AccountName) (DocumentAuditState, error) {
+	var states []DocumentAuditState
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "docaudit"
+	request.Limit = 1
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return DocumentAuditState{}, fmt.Errorf("get table rows %v", err)
+	}
+
+	err = response.JSONToStructs(&states)
+	if err != nil {
+		return DocumentAuditState{}, fmt.Errorf("json to structs %v", err)
+	}
+
+	if len(states) == 0 {
+		return DocumentAuditState{}, nil
+	}
+	return states[0], nil
+}
+
+type mergeDoc struct {
+	Updater eos.AccountName `json:"updater"`
+	Hash    eos.Checksum256 `json:"hash"`
+	Deltas  []ContentGroup  `json:"deltas"`
+}
+
+// MergeDocument replaces the document with its next version, which the contract builds by
+// merging deltas into the current content: groups are matched by content_group_label, a
+// monostate value removes an item and a delete_group item removes the group
+func MergeDocument(ctx context.Context, api *eos.API,
+	contract, updater eos.AccountName,
+	hash eos.Checksum256, deltas []ContentGroup) (Document, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("mergedoc"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: updater, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(mergeDoc{
+			Updater: updater,
+			Hash:    hash,
+			Deltas:  deltas,
+		}),
+	}}
+	_, err := eostest.ExecWithRetry(ctx, api, actions)
+	if err != nil {
+		return Document{}, fmt.Errorf("execute transaction merge document %v: %v", hash.String(), err)
+	}
+
+	lastDoc, err := GetLastDocument(ctx, api, contract)
+	if err != nil {
+		return Document{}, fmt.Errorf("get last document: %v", err)
+	}
+	return lastDoc, nil
+}
+
 type eraseDoc struct {
 	Hash eos.Checksum256 `json:"hash"`
 }
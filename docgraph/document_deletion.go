@@ -0,0 +1,72 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+
+	eostest "github.com/digital-scarcity/eos-go-test"
+	eos "github.com/eoscanada/eos-go"
+)
+
+// PendingDeletion tracks a document being erased in batches (see the erasebatch action)
+type PendingDeletion struct {
+	ID           eos.Uint64         `json:"id"`
+	DocumentHash eos.Checksum256    `json:"document_hash"`
+	EdgesRemoved eos.Uint64         `json:"edges_removed"`
+	Batches      eos.Uint64         `json:"batches"`
+	Started      eos.BlockTimestamp `json:"started"`
+}
+
+type eraseBatch struct {
+	Hash      eos.Checksum256 `json:"hash"`
+	BatchSize uint64          `json:"batch_size"`
+}
+
+// EraseDocumentInBatches removes up to batchSize edges of the document and erases it once
+// none are left; call it again while GetPendingDeletion still finds the deletion
+func EraseDocumentInBatches(ctx context.Context, api *eos.API,
+	contract, caller eos.AccountName,
+	hash eos.Checksum256, batchSize uint64) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("erasebatch"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: caller, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(eraseBatch{
+			Hash:      hash,
+			BatchSize: batchSize,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+// GetPendingDeletion returns the progress of the batched deletion of a document, if one is running
+func GetPendingDeletion(ctx context.Context, api *eos.API, contract eos.AccountName, hash eos.Checksum256) (PendingDeletion, bool, error) {
+	var deletions []PendingDeletion
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "deletions"
+	request.Index = "2"
+	request.KeyType = "sha256"
+	request.LowerBound = hash.String()
+	request.UpperBound = hash.String()
+	request.Limit = 1
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return PendingDeletion{}, false, fmt.Errorf("get table rows %v: %v", hash.String(), err)
+	}
+
+	err = response.JSONToStructs(&deletions)
+	if err != nil {
+		return PendingDeletion{}, false, fmt.Errorf("json to structs %v: %v", hash.String(), err)
+	}
+
+	if len(deletions) == 0 {
+		return PendingDeletion{}, false, nil
+	}
+	return deletions[0], true, nil
+}
@@ -104,12 +104,16 @@ func GetEdgesToDocumentWithEdge(ctx context.Context, api *eos.API, contract eos.
 }
 
 // GetLastDocument retrieves the last document that was created from the contract
+// Documents are read through the bycreated index because hash-derived primary keys
+// are not ordered by creation
 func GetLastDocument(ctx context.Context, api *eos.API, contract eos.AccountName) (Document, error) {
 	var docs []Document
 	var request eos.GetTableRowsRequest
 	request.Code = string(contract)
 	request.Scope = string(contract)
 	request.Table = "documents"
+	request.Index = "4"
+	request.KeyType = "i64"
 	request.Reverse = true
 	request.Limit = 1
 	request.JSON = true
@@ -124,6 +128,12 @@ func GetLastDocument(ctx context.Context, api *eos.API, contract eos.AccountName
 		log.Println("Error with JSONToStructs: ", err)
 		return Document{}, err
 	}
+
+	err = docs[0].loadGroups(ctx, api, contract)
+	if err != nil {
+		log.Println("Error loading document groups: ", err)
+		return Document{}, err
+	}
 	return docs[0], nil
 }
 
@@ -160,11 +170,11 @@ func GetLastDocumentOfEdge(ctx context.Context, api *eos.API, contract eos.Accou
 	return Document{}, fmt.Errorf("no document with edge found: %v", string(edgeName))
 }
 
-func getRange(ctx context.Context, api *eos.API, contract eos.AccountName, id, count int) ([]Document, bool, error) {
+func getRange(ctx context.Context, api *eos.API, contract eos.AccountName, id uint64, count int) ([]Document, bool, error) {
 	var documents []Document
 	var request eos.GetTableRowsRequest
 	if id > 0 {
-		request.LowerBound = strconv.Itoa(id)
+		request.LowerBound = strconv.FormatUint(id, 10)
 	}
 	request.Code = string(contract)
 	request.Scope = string(contract)
@@ -180,6 +190,13 @@ func getRange(ctx context.Context, api *eos.API, contract eos.AccountName, id, c
 	if err != nil {
 		return []Document{}, false, fmt.Errorf("json to structs %v", err)
 	}
+
+	for i := range documents {
+		err = documents[i].loadGroups(ctx, api, contract)
+		if err != nil {
+			return []Document{}, false, err
+		}
+	}
 	return documents, response.More, nil
 }
 
@@ -220,7 +237,7 @@ func GetAllDocuments(ctx context.Context, api *eos.API, contract eos.AccountName
 	bar.Add(batchSize)
 
 	for more {
-		batch, more, err = getRange(ctx, api, contract, int(batch[len(batch)-1].ID), batchSize)
+		batch, more, err = getRange(ctx, api, contract, uint64(batch[len(batch)-1].ID), batchSize)
 		if err != nil {
 			return []Document{}, fmt.Errorf("json to structs %v", err)
 		}
@@ -0,0 +1,60 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+
+	eos "github.com/eoscanada/eos-go"
+)
+
+// DocumentGroup is one content group of a document saved with group storage
+// (see the setstorage action); the row is shared by all documents holding it
+type DocumentGroup struct {
+	ID           eos.Uint64      `json:"id"`
+	Hash         eos.Checksum256 `json:"hash"`
+	References   uint32          `json:"references"`
+	ContentGroup ContentGroup    `json:"content_group"`
+}
+
+func getDocumentGroup(ctx context.Context, api *eos.API, contract eos.AccountName, id uint64) (DocumentGroup, error) {
+	var groups []DocumentGroup
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "docgroups"
+	request.LowerBound = strconv.FormatUint(id, 10)
+	request.UpperBound = strconv.FormatUint(id, 10)
+	request.Limit = 1
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return DocumentGroup{}, fmt.Errorf("get table rows %v: %v", id, err)
+	}
+
+	err = response.JSONToStructs(&groups)
+	if err != nil {
+		return DocumentGroup{}, fmt.Errorf("json to structs %v: %v", id, err)
+	}
+
+	if len(groups) == 0 {
+		return DocumentGroup{}, fmt.Errorf("document group not found %v", id)
+	}
+	return groups[0], nil
+}
+
+// loadGroups fills in the content groups of a document saved with group storage
+func (d *Document) loadGroups(ctx context.Context, api *eos.API, contract eos.AccountName) error {
+	if len(d.GroupKeys) == 0 || len(d.ContentGroups) > 0 {
+		return nil
+	}
+
+	for _, key := range d.GroupKeys {
+		group, err := getDocumentGroup(ctx, api, contract, uint64(key))
+		if err != nil {
+			return fmt.Errorf("load groups of %v: %v", d.Hash.String(), err)
+		}
+		d.ContentGroups = append(d.ContentGroups, group.ContentGroup)
+	}
+	return nil
+}
@@ -0,0 +1,52 @@
+package docgraph
+
+import (
+	"bytes"
+	"crypto/sha256"
+)
+
+// GroupTreeHash returns the version 2 document hash over the hashes of its
+// content groups: sha256 of 0x02 and the Merkle root, where a node is sha256
+// of 0x01 and its two children and an odd node moves up unchanged
+func GroupTreeHash(groupHashes [][]byte) []byte {
+	level := make([][]byte, len(groupHashes))
+	copy(level, groupHashes)
+
+	for len(level) > 1 {
+		var next [][]byte
+		for i := 0; i < len(level); i += 2 {
+			if i+1 == len(level) {
+				next = append(next, level[i])
+				continue
+			}
+			node := sha256.New()
+			node.Write([]byte{0x01})
+			node.Write(level[i])
+			node.Write(level[i+1])
+			next = append(next, node.Sum(nil))
+		}
+		level = next
+	}
+
+	root := sha256.New()
+	root.Write([]byte{0x02})
+	if len(level) == 1 {
+		root.Write(level[0])
+	}
+	return root.Sum(nil)
+}
+
+// VerifyGroupHashes checks that the stored group hashes of a version 2
+// document produce its hash; a group read on its own, e.g. from the
+// docgroups table, is then verified by comparing its hash to GroupHashes
+func (d *Document) VerifyGroupHashes() bool {
+	if d.HashVersion != 2 {
+		return false
+	}
+
+	groupHashes := make([][]byte, len(d.GroupHashes))
+	for i, groupHash := range d.GroupHashes {
+		groupHashes[i] = groupHash
+	}
+	return bytes.Equal(GroupTreeHash(groupHashes), d.Hash)
+}
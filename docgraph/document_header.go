@@ -0,0 +1,67 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+
+	eos "github.com/eoscanada/eos-go"
+)
+
+// DocumentHeader is the compact row stored next to each document once the
+// contract has enabled header storage (see the migdocheads action)
+type DocumentHeader struct {
+	ID          eos.Uint64         `json:"id"`
+	Hash        eos.Checksum256    `json:"hash"`
+	Creator     eos.AccountName    `json:"creator"`
+	Type        eos.Name           `json:"type"`
+	BodySize    uint32             `json:"body_size"`
+	CreatedDate eos.BlockTimestamp `json:"created_date"`
+}
+
+func getHeaderRange(ctx context.Context, api *eos.API, contract eos.AccountName, id uint64, count int) ([]DocumentHeader, bool, error) {
+	var headers []DocumentHeader
+	var request eos.GetTableRowsRequest
+	if id > 0 {
+		request.LowerBound = strconv.FormatUint(id, 10)
+	}
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "docheaders"
+	request.Limit = uint32(count)
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return []DocumentHeader{}, false, fmt.Errorf("get table rows %v", err)
+	}
+
+	err = response.JSONToStructs(&headers)
+	if err != nil {
+		return []DocumentHeader{}, false, fmt.Errorf("json to structs %v", err)
+	}
+	return headers, response.More, nil
+}
+
+// GetAllDocumentHeaders reads the header of every document without reading
+// the content, so it pages through far fewer bytes than GetAllDocuments
+func GetAllDocumentHeaders(ctx context.Context, api *eos.API, contract eos.AccountName) ([]DocumentHeader, error) {
+
+	var allHeaders []DocumentHeader
+	batchSize := 1000
+
+	batch, more, err := getHeaderRange(ctx, api, contract, 0, batchSize)
+	if err != nil {
+		return []DocumentHeader{}, fmt.Errorf("cannot get initial range of document headers %v", err)
+	}
+	allHeaders = append(allHeaders, batch...)
+
+	for more {
+		batch, more, err = getHeaderRange(ctx, api, contract, uint64(batch[len(batch)-1].ID)+1, batchSize)
+		if err != nil {
+			return []DocumentHeader{}, fmt.Errorf("cannot get range of document headers %v", err)
+		}
+		allHeaders = append(allHeaders, batch...)
+	}
+
+	return allHeaders, nil
+}
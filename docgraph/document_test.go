@@ -5,6 +5,7 @@ import (
 	"io/ioutil"
 	"testing"
 
+	eostest "github.com/digital-scarcity/eos-go-test"
 	"github.com/eoscanada/eos-go"
 
 	"github.com/hypha-dao/document-graph/docgraph"
@@ -80,6 +81,37 @@ func TestLoadDocument(t *testing.T) {
 	assert.ErrorContains(t, err, "Internal Service Error")
 }
 
+func TestDocumentCache(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	doc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	other, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	// the action checks the cache hits and misses itself
+	_, err = CacheTest(env.ctx, &env.api, env.Docs, doc.Hash, randomContentGroups(), randomContentGroups())
+	assert.NilError(t, err)
+
+	_, err = docgraph.LoadDocument(env.ctx, &env.api, env.Docs, doc.Hash.String())
+	assert.ErrorContains(t, err, "document not found")
+
+	allDocuments, err := docgraph.GetAllDocuments(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(allDocuments), 1)
+	assert.Equal(t, allDocuments[0].Hash.String(), other.Hash.String())
+
+	// the cache does not outlive the action: the erased document can not be updated again
+	_, err = CacheTest(env.ctx, &env.api, env.Docs, doc.Hash, randomContentGroups(), randomContentGroups())
+	assert.ErrorContains(t, err, "document not found")
+}
+
 func TestEraseDocument(t *testing.T) {
 
 	teardownTestCase := setupTestCase(t)
@@ -99,6 +131,403 @@ func TestEraseDocument(t *testing.T) {
 	assert.ErrorContains(t, err, "document not found")
 }
 
+func TestMergeDocument(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	doc, err := docgraph.CreateDocument(env.ctx, &env.api, env.Docs, env.Creators[0], "examples/each-type.json")
+	assert.NilError(t, err)
+
+	// only the changed salary and the removed vote count are sent
+	salary, _ := eos.NewAssetFromString("150.00 USD")
+	deltas := []docgraph.ContentGroup{{
+		{Label: "content_group_label", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("string"), Impl: "My Content Group Label"}}},
+		{Label: "salary_amount", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("asset"), Impl: salary}}},
+		{Label: "vote_count", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("monostate"), Impl: int64(0)}}},
+	}}
+
+	merged, err := docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], doc.Hash, deltas)
+	assert.NilError(t, err)
+	assert.Assert(t, merged.Hash.String() != doc.Hash.String())
+	assert.Equal(t, merged.Creator, env.Creators[1])
+	assert.Equal(t, len(merged.ContentGroups), len(doc.ContentGroups))
+	assert.Equal(t, len(merged.ContentGroups[0]), len(doc.ContentGroups[0])-1)
+	untouched := docgraph.Document{ContentGroups: merged.ContentGroups[1:]}
+	assert.Assert(t, untouched.IsEqual(docgraph.Document{ContentGroups: doc.ContentGroups[1:]}))
+
+	_, err = GetAssetTest(env.ctx, &env.api, env.Docs, merged, "My Content Group Label", "salary_amount", salary)
+	assert.NilError(t, err)
+
+	_, err = docgraph.LoadDocument(env.ctx, &env.api, env.Docs, doc.Hash.String())
+	assert.ErrorContains(t, err, "document not found")
+
+	// deltas that change nothing are refused
+	_, err = docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], merged.Hash, deltas[:0])
+	assert.ErrorContains(t, err, "deltas do not change document")
+}
+
+func TestDiffDocument(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	item := func(label string, value int64) docgraph.ContentItem {
+		return docgraph.ContentItem{Label: label, Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("int64"), Impl: value}}}
+	}
+	labelled := func(label string, itemLabel string, value int64) docgraph.ContentGroup {
+		return docgraph.ContentGroup{{Label: "content_group_label", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("string"), Impl: label}}},
+			item(itemLabel, value)}
+	}
+	create := func(cgs ...docgraph.ContentGroup) docgraph.Document {
+		doc, err := CreateDocumentFromGroups(env.ctx, &env.api, env.Docs, env.Creators[0], cgs)
+		assert.NilError(t, err)
+		return doc
+	}
+
+	// two groups labelled dup
+	original := create(labelled("dup", "a", 1), labelled("keep", "k", 1), labelled("dup", "a", 2), labelled("tail", "t", 1),
+		docgraph.ContentGroup{item("unlabelled", 3)})
+
+	updates := []docgraph.Document{
+		// nothing changed, so each dup group is paired with itself
+		original,
+		// a group between the duplicates changed
+		create(labelled("dup", "a", 1), labelled("keep", "k", 2), labelled("dup", "a", 2), labelled("tail", "t", 1),
+			docgraph.ContentGroup{item("unlabelled", 3)}),
+		// the first dup group changed, which merge updates in place
+		create(labelled("dup", "a", 5), labelled("keep", "k", 1), labelled("dup", "a", 2), labelled("tail", "t", 1),
+			docgraph.ContentGroup{item("unlabelled", 3)}),
+		// the first dup group dropped, which merge deletes from the front
+		create(labelled("keep", "k", 1), labelled("dup", "a", 2), labelled("tail", "t", 1),
+			docgraph.ContentGroup{item("unlabelled", 3)}),
+		// the second dup group changed, which merge can only reach by deleting both and
+		// appending them again
+		create(labelled("keep", "k", 1), labelled("tail", "t", 1), docgraph.ContentGroup{item("unlabelled", 3)},
+			labelled("dup", "a", 1), labelled("dup", "a", 3)),
+		// a third dup group appended
+		create(labelled("keep", "k", 1), labelled("tail", "t", 1), docgraph.ContentGroup{item("unlabelled", 3)},
+			labelled("dup", "a", 1), labelled("dup", "a", 2), labelled("dup", "a", 4)),
+	}
+	for _, updated := range updates {
+		_, err := DiffTest(env.ctx, &env.api, env.Docs, original, updated)
+		assert.NilError(t, err)
+	}
+
+	// merge can not change the second dup group where it is
+	inPlace := create(labelled("dup", "a", 1), labelled("keep", "k", 1), labelled("dup", "a", 3), labelled("tail", "t", 1),
+		docgraph.ContentGroup{item("unlabelled", 3)})
+	_, err := DiffTest(env.ctx, &env.api, env.Docs, original, inPlace)
+	assert.ErrorContains(t, err, "diff: updated document can not be reached by merging into original")
+
+	// and back
+	_, err = DiffTest(env.ctx, &env.api, env.Docs, updates[2], original)
+	assert.NilError(t, err)
+}
+
+func TestMergeDocumentGroups(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	item := func(label, typeID string, value interface{}) docgraph.ContentItem {
+		return docgraph.ContentItem{Label: label, Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID(typeID), Impl: value}}}
+	}
+	group := func(label, itemLabel string, value int64) docgraph.ContentGroup {
+		return docgraph.ContentGroup{item("content_group_label", "string", label), item(itemLabel, "int64", value)}
+	}
+	deleteGroup := func(label string) docgraph.ContentGroup {
+		return docgraph.ContentGroup{item("content_group_label", "string", label), item("delete_group", "int64", int64(1))}
+	}
+	// two groups share the dup label; keep tells the documents apart
+	groups := func(keep int64) []docgraph.ContentGroup {
+		return []docgraph.ContentGroup{group("dup", "a", 1), group("keep", "k", keep), group("dup", "a", 2), group("tail", "t", 1)}
+	}
+	value := func(d docgraph.Document, groupIndex int, itemLabel string) int64 {
+		content, err := d.ContentGroups[groupIndex].GetContent(itemLabel)
+		assert.NilError(t, err)
+		v, err := content.Int64()
+		assert.NilError(t, err)
+		return v
+	}
+
+	// with duplicate labels the deltas update the first group
+	doc, err := CreateDocumentFromGroups(env.ctx, &env.api, env.Docs, env.Creators[0], groups(1))
+	assert.NilError(t, err)
+
+	merged, err := docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], doc.Hash,
+		[]docgraph.ContentGroup{group("dup", "a", 10)})
+	assert.NilError(t, err)
+	assert.Equal(t, len(merged.ContentGroups), 4)
+	assert.Equal(t, value(merged, 0, "a"), int64(10))
+	assert.Equal(t, value(merged, 2, "a"), int64(2))
+
+	// a group the same deltas append cannot be deleted by them
+	doc, err = CreateDocumentFromGroups(env.ctx, &env.api, env.Docs, env.Creators[0], groups(2))
+	assert.NilError(t, err)
+
+	_, err = docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], doc.Hash,
+		[]docgraph.ContentGroup{group("fresh", "x", 1), deleteGroup("fresh")})
+	assert.ErrorContains(t, err, "Can't remove unexisting group: fresh")
+
+	// after a delete, later delta groups still update the group with their label
+	merged, err = docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], doc.Hash,
+		[]docgraph.ContentGroup{deleteGroup("keep"), group("tail", "t", 5)})
+	assert.NilError(t, err)
+	assert.Equal(t, len(merged.ContentGroups), 3)
+	assert.Equal(t, value(merged, 1, "a"), int64(2))
+	assert.Equal(t, value(merged, 2, "t"), int64(5))
+
+	// and once the first of two duplicates is deleted, the second one is updated
+	merged, err = docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], merged.Hash,
+		[]docgraph.ContentGroup{deleteGroup("dup"), group("dup", "a", 20)})
+	assert.NilError(t, err)
+	assert.Equal(t, len(merged.ContentGroups), 2)
+	assert.Equal(t, value(merged, 0, "a"), int64(20))
+	assert.Equal(t, value(merged, 1, "t"), int64(5))
+
+	// with version 2 hashes, the groups the deltas leave alone keep their hashes
+	_, err = SetHashVersion(env.ctx, &env.api, env.Docs, 2)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	doc, err = CreateDocumentFromGroups(env.ctx, &env.api, env.Docs, env.Creators[0], groups(3))
+	assert.NilError(t, err)
+	assert.Equal(t, len(doc.GroupHashes), 4)
+
+	merged, err = docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], doc.Hash,
+		[]docgraph.ContentGroup{group("tail", "t", 7)})
+	assert.NilError(t, err)
+	assert.Assert(t, merged.VerifyGroupHashes())
+	assert.Equal(t, len(merged.GroupHashes), 4)
+	for i := 0; i < 3; i++ {
+		assert.Equal(t, merged.GroupHashes[i].String(), doc.GroupHashes[i].String())
+	}
+	assert.Assert(t, merged.GroupHashes[3].String() != doc.GroupHashes[3].String())
+
+	// a deleted group drops its hash and the later ones move down
+	deleted, err := docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[1], merged.Hash,
+		[]docgraph.ContentGroup{deleteGroup("keep")})
+	assert.NilError(t, err)
+	assert.Assert(t, deleted.VerifyGroupHashes())
+	assert.Equal(t, len(deleted.GroupHashes), 3)
+	assert.Equal(t, deleted.GroupHashes[0].String(), merged.GroupHashes[0].String())
+	assert.Equal(t, deleted.GroupHashes[1].String(), merged.GroupHashes[2].String())
+	assert.Equal(t, deleted.GroupHashes[2].String(), merged.GroupHashes[3].String())
+
+	// the reused hashes match the content when recomputed
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "auditdocs", 100)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	audit, err := docgraph.GetDocumentAuditState(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Assert(t, !audit.Running)
+	assert.Equal(t, audit.Mismatches, eos.Uint64(0))
+
+	_, err = SetHashVersion(env.ctx, &env.api, env.Docs, 1)
+	assert.NilError(t, err)
+}
+
+func TestEraseDocumentInBatches(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	doc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	for i := 0; i < 5; i++ {
+		other, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], doc.Hash, other.Hash, "test")
+		assert.NilError(t, err)
+	}
+
+	// two edges per action: the first two calls leave the document in place
+	for i := 1; i <= 2; i++ {
+		_, err = docgraph.EraseDocumentInBatches(env.ctx, &env.api, env.Docs, env.Creators[2], doc.Hash, 2)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+
+		deletion, pending, err := docgraph.GetPendingDeletion(env.ctx, &env.api, env.Docs, doc.Hash)
+		assert.NilError(t, err)
+		assert.Assert(t, pending)
+		assert.Equal(t, uint64(deletion.EdgesRemoved), uint64(2*i))
+
+		_, err = docgraph.LoadDocument(env.ctx, &env.api, env.Docs, doc.Hash.String())
+		assert.NilError(t, err)
+	}
+
+	// any account can continue the deletion
+	_, err = docgraph.EraseDocumentInBatches(env.ctx, &env.api, env.Docs, env.Creators[3], doc.Hash, 2)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	_, pending, err := docgraph.GetPendingDeletion(env.ctx, &env.api, env.Docs, doc.Hash)
+	assert.NilError(t, err)
+	assert.Assert(t, !pending)
+
+	_, err = docgraph.LoadDocument(env.ctx, &env.api, env.Docs, doc.Hash.String())
+	assert.ErrorContains(t, err, "document not found")
+
+	edges, err := docgraph.GetAllEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(edges), 0)
+}
+
+func TestMigrateDocumentKeys(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 4)
+	for i := 0; i < 4; i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	// migrate one document per action; re-keyed rows are revisited, so allow extra rounds
+	var state docgraph.DocumentKeyState
+	for i := 1; i <= 8; i++ {
+		_, err = RunBatch(env.ctx, &env.api, env.Docs, "migdockeys", 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+
+		// documents must stay loadable while the table holds both key versions
+		for _, doc := range docs {
+			loadedDoc, err := docgraph.LoadDocument(env.ctx, &env.api, env.Docs, doc.Hash.String())
+			assert.NilError(t, err)
+			assert.Equal(t, doc.Hash.String(), loadedDoc.Hash.String())
+		}
+
+		state, err = docgraph.GetDocumentKeyState(env.ctx, &env.api, env.Docs)
+		assert.NilError(t, err)
+		assert.Equal(t, state.KeyVersion, uint8(2))
+		if !state.Migrating {
+			break
+		}
+	}
+
+	// the migration finished within the rounds and a further call leaves it finished
+	assert.Assert(t, !state.Migrating)
+	assert.Equal(t, uint64(state.Cursor), uint64(0))
+
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "migdockeys", 1)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	state, err = docgraph.GetDocumentKeyState(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, state.KeyVersion, uint8(2))
+	assert.Assert(t, !state.Migrating)
+
+	// documents created after the migration use the new keys and can still be erased
+	randomDoc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	lastDoc, err := docgraph.GetLastDocument(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, randomDoc.Hash.String(), lastDoc.Hash.String())
+
+	_, err = docgraph.EraseDocument(env.ctx, &env.api, env.Docs, docs[0].Hash)
+	assert.NilError(t, err)
+
+	_, err = docgraph.LoadDocument(env.ctx, &env.api, env.Docs, docs[0].Hash.String())
+	assert.ErrorContains(t, err, "document not found")
+}
+
+func TestMigrateDocumentHeaders(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	docs := make([]docgraph.Document, 3)
+	for i := 0; i < 3; i++ {
+		var err error
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	// the first call enables headers, later calls backfill one older document each
+	for i := 1; i <= 4; i++ {
+		_, err := RunBatch(env.ctx, &env.api, env.Docs, "migdocheads", 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+
+	// documents created and erased after the migration keep their headers in sync
+	newDoc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	_, err = docgraph.EraseDocument(env.ctx, &env.api, env.Docs, docs[0].Hash)
+	assert.NilError(t, err)
+
+	headers, err := docgraph.GetAllDocumentHeaders(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+
+	allDocuments, err := docgraph.GetAllDocuments(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(allDocuments), len(headers))
+
+	found := false
+	for _, header := range headers {
+		assert.Assert(t, header.Hash.String() != docs[0].Hash.String())
+		if header.Hash.String() == newDoc.Hash.String() {
+			found = true
+			assert.Equal(t, header.Creator, newDoc.Creator)
+		}
+	}
+	assert.Assert(t, found)
+}
+
+func TestAuditDocuments(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	for i := 0; i < 3; i++ {
+		_, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	// each call continues the pass where the previous one stopped, then a new pass begins
+	for i := 1; i <= 6; i++ {
+		_, err := RunBatch(env.ctx, &env.api, env.Docs, "auditdocs", 2)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+}
+
 func TestCreateRoot(t *testing.T) {
 
 	teardownTestCase := setupTestCase(t)
@@ -164,6 +593,19 @@ func TestGetContent(t *testing.T) {
 
 				_, err = GetAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "Nonexistent Content Group Label", "salary_amount", salary)
 				assert.ErrorContains(t, err, "contentGroup or contentLabel does not exist")
+
+				// DocumentView reads the same values and fails the same way
+				_, err = ViewAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "My Content Group Label", "salary_amount", salary)
+				assert.NilError(t, err)
+
+				_, err = ViewAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "My Content Group Label", "salary_amount", wrongSalary)
+				assert.ErrorContains(t, err, "read value does not equal content value")
+
+				_, err = ViewAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "My Content Group Label", "wrong_content_label", salary)
+				assert.ErrorContains(t, err, "contentGroup or contentLabel does not exist")
+
+				_, err = ViewAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "Nonexistent Content Group Label", "salary_amount", salary)
+				assert.ErrorContains(t, err, "contentGroup or contentLabel does not exist")
 			})
 		}
 	})
@@ -212,7 +654,221 @@ func TestGetGroup(t *testing.T) {
 				_, err = GetGroupTest(env.ctx, &env.api, env.Docs, lastDoc, "Nonexistent Content Group Label")
 				assert.ErrorContains(t, err, "group was not found")
 
+				_, err = ViewGroupTest(env.ctx, &env.api, env.Docs, lastDoc, "My Content Group Label")
+				assert.NilError(t, err)
+
+				_, err = ViewGroupTest(env.ctx, &env.api, env.Docs, lastDoc, "Nonexistent Content Group Label")
+				assert.ErrorContains(t, err, "group was not found")
+
 			})
 		}
 	})
 }
+
+func TestIndexedContentWrapper(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	eachType, err := docgraph.CreateDocument(env.ctx, &env.api, env.Docs, env.Creators[0], "examples/each-type.json")
+	assert.NilError(t, err)
+
+	_, err = IndexedTest(env.ctx, &env.api, env.Docs, eachType)
+	assert.NilError(t, err)
+
+	// duplicate group labels and an unlabelled group
+	item := func(label string, value int64) docgraph.ContentItem {
+		return docgraph.ContentItem{Label: label, Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("int64"), Impl: value}}}
+	}
+	labelled := func(label string, itemLabel string, value int64) docgraph.ContentGroup {
+		return docgraph.ContentGroup{{Label: "content_group_label", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("string"), Impl: label}}},
+			item(itemLabel, value)}
+	}
+	duplicates, err := CreateDocumentFromGroups(env.ctx, &env.api, env.Docs, env.Creators[0], []docgraph.ContentGroup{
+		labelled("dup", "a", 1), labelled("keep", "k", 1), labelled("dup", "a", 2), labelled("tail", "t", 1),
+		{item("unlabelled", 3)},
+	})
+	assert.NilError(t, err)
+
+	_, err = IndexedTest(env.ctx, &env.api, env.Docs, duplicates)
+	assert.NilError(t, err)
+
+	for i := 0; i < 3; i++ {
+		random, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+
+		_, err = IndexedTest(env.ctx, &env.api, env.Docs, random)
+		assert.NilError(t, err)
+	}
+}
+
+func TestGetFields(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	doc, err := docgraph.CreateDocument(env.ctx, &env.api, env.Docs, env.Creators[0], "examples/each-type.json")
+	assert.NilError(t, err)
+
+	// a second asset next to salary_amount
+	bonus, _ := eos.NewAssetFromString("5.00 USD")
+	doc, err = docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[0], doc.Hash, []docgraph.ContentGroup{{
+		{Label: "content_group_label", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("string"), Impl: "My Content Group Label"}}},
+		{Label: "bonus_amount", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("asset"), Impl: bonus}}},
+	}})
+	assert.NilError(t, err)
+
+	group := "My Content Group Label"
+
+	for _, indexed := range []bool{false, true} {
+		t.Log("Reading fields with indexed: ", indexed)
+
+		_, err = GetFieldsTest(env.ctx, &env.api, env.Docs, doc, group, "salary_amount", "referrer", "bonus_amount", indexed)
+		assert.NilError(t, err)
+
+		// both fields are the same item
+		_, err = GetFieldsTest(env.ctx, &env.api, env.Docs, doc, group, "salary_amount", "referrer", "salary_amount", indexed)
+		assert.NilError(t, err)
+
+		_, err = GetFieldsTest(env.ctx, &env.api, env.Docs, doc, group, "salary_amount", "referrer", "missing_amount", indexed)
+		assert.ErrorContains(t, err, "group: My Content Group Label; content: missing_amount is required but not found")
+
+		_, err = GetFieldsTest(env.ctx, &env.api, env.Docs, doc, group, "vote_count", "referrer", "bonus_amount", indexed)
+		assert.ErrorContains(t, err, "group: My Content Group Label; content: vote_count is not of expected type")
+
+		// every missing and mistyped item is named in one message
+		_, err = GetFieldsTest(env.ctx, &env.api, env.Docs, doc, group, "vote_count", "nobody", "missing_amount", indexed)
+		assert.ErrorContains(t, err, "content: nobody, missing_amount is required but not found; content: vote_count is not of expected type")
+
+		_, err = GetFieldsTest(env.ctx, &env.api, env.Docs, doc, "Nonexistent Content Group Label", "salary_amount", "referrer", "bonus_amount", indexed)
+		assert.ErrorContains(t, err, "group: Nonexistent Content Group Label is required but not found")
+	}
+}
+
+func TestDocumentSchema(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	doc, err := docgraph.CreateDocument(env.ctx, &env.api, env.Docs, env.Creators[0], "examples/each-type.json")
+	assert.NilError(t, err)
+
+	_, err = SchemaTest(env.ctx, &env.api, env.Docs, doc)
+	assert.NilError(t, err)
+
+	// vote_count removed and referrer turned into a string
+	broken, err := docgraph.MergeDocument(env.ctx, &env.api, env.Docs, env.Creators[0], doc.Hash, []docgraph.ContentGroup{{
+		{Label: "content_group_label", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("string"), Impl: "My Content Group Label"}}},
+		{Label: "referrer", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("string"), Impl: "friendacct"}}},
+		{Label: "vote_count", Value: &docgraph.FlexValue{
+			BaseVariant: eos.BaseVariant{TypeID: docgraph.FlexValueVariant.TypeID("monostate"), Impl: int64(0)}}},
+	}})
+	assert.NilError(t, err)
+
+	_, err = SchemaTest(env.ctx, &env.api, env.Docs, broken)
+	assert.ErrorContains(t, err, "document schema; content: My Content Group Label/vote_count is required but not found; "+
+		"content: My Content Group Label/referrer is not of expected type")
+}
+
+func TestGroupStorage(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	_, err := SetStorage(env.ctx, &env.api, env.Docs, true)
+	assert.NilError(t, err)
+
+	lastDoc, err := docgraph.CreateDocument(env.ctx, &env.api, env.Docs, env.Creators[0], "examples/each-type.json")
+	assert.NilError(t, err)
+	assert.Assert(t, len(lastDoc.GroupKeys) > 0)
+
+	// the content groups are read back from the docgroups table
+	data, err := ioutil.ReadFile("examples/each-type.json")
+	assert.NilError(t, err)
+	var documentFromFile docgraph.Document
+	err = json.Unmarshal(data, &documentFromFile)
+	assert.NilError(t, err)
+	assert.Assert(t, lastDoc.IsEqual(documentFromFile))
+
+	salary, _ := eos.NewAssetFromString("130.00 USD")
+	_, err = GetAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "My Content Group Label", "salary_amount", salary)
+	assert.NilError(t, err)
+
+	_, err = ViewAssetTest(env.ctx, &env.api, env.Docs, lastDoc, "My Content Group Label", "salary_amount", salary)
+	assert.NilError(t, err)
+
+	randomDoc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+	assert.Assert(t, len(randomDoc.GroupKeys) > 0)
+
+	_, err = docgraph.EraseDocument(env.ctx, &env.api, env.Docs, lastDoc.Hash)
+	assert.NilError(t, err)
+
+	_, err = SetStorage(env.ctx, &env.api, env.Docs, false)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	inlineDoc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+	assert.Equal(t, len(inlineDoc.GroupKeys), 0)
+
+	loadedDoc, err := docgraph.LoadDocument(env.ctx, &env.api, env.Docs, randomDoc.Hash.String())
+	assert.NilError(t, err)
+	assert.Assert(t, loadedDoc.IsEqual(randomDoc))
+}
+
+func TestMerkleHash(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	flatDoc, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+	assert.Assert(t, flatDoc.HashVersion != 2)
+
+	_, err = SetHashVersion(env.ctx, &env.api, env.Docs, 2)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	merkleDoc, err := docgraph.CreateDocument(env.ctx, &env.api, env.Docs, env.Creators[0], "examples/each-type.json")
+	assert.NilError(t, err)
+	assert.Equal(t, merkleDoc.HashVersion, uint8(2))
+	assert.Equal(t, len(merkleDoc.GroupHashes), len(merkleDoc.ContentGroups))
+	assert.Assert(t, merkleDoc.VerifyGroupHashes())
+
+	// both hash versions are read and verified from the same table
+	loadedDoc, err := docgraph.LoadDocument(env.ctx, &env.api, env.Docs, flatDoc.Hash.String())
+	assert.NilError(t, err)
+	assert.Assert(t, loadedDoc.IsEqual(flatDoc))
+
+	salary, _ := eos.NewAssetFromString("130.00 USD")
+	_, err = GetAssetTest(env.ctx, &env.api, env.Docs, merkleDoc, "My Content Group Label", "salary_amount", salary)
+	assert.NilError(t, err)
+
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "auditdocs", 10)
+	assert.NilError(t, err)
+
+	_, err = SetHashVersion(env.ctx, &env.api, env.Docs, 1)
+	assert.NilError(t, err)
+}
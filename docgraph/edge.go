@@ -12,7 +12,7 @@ import (
 
 // Edge is a directional, named connection from one graph to another
 type Edge struct {
-	ID          uint64             `json:"id"`
+	ID          eos.Uint64         `json:"id"`
 	Creator     eos.Name           `json:"creator"`
 	FromNode    eos.Checksum256    `json:"from_node"`
 	ToNode      eos.Checksum256    `json:"to_node"`
@@ -107,12 +107,12 @@ func RemoveEdge(ctx context.Context, api *eos.API,
 // 	return edges, nil
 // }
 
-func getEdgeRange(ctx context.Context, api *eos.API, contract eos.AccountName, id, count int) ([]Edge, bool, error) {
+func getEdgeRange(ctx context.Context, api *eos.API, contract eos.AccountName, id uint64, count int) ([]Edge, bool, error) {
 	var edges []Edge
 	var request eos.GetTableRowsRequest
 
 	if id > 0 {
-		request.LowerBound = strconv.Itoa(id)
+		request.LowerBound = strconv.FormatUint(id, 10)
 	}
 	request.Code = string(contract)
 	request.Scope = string(contract)
@@ -145,7 +145,7 @@ func GetAllEdges(ctx context.Context, api *eos.API, contract eos.AccountName) ([
 	allEdges = append(allEdges, batch...)
 
 	for more {
-		batch, more, err = getEdgeRange(ctx, api, contract, int(batch[len(batch)-1].ID), batchSize)
+		batch, more, err = getEdgeRange(ctx, api, contract, uint64(batch[len(batch)-1].ID), batchSize)
 		if err != nil {
 			return []Edge{}, fmt.Errorf("cannot get range of edges %v", err)
 		}
@@ -0,0 +1,61 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+
+	eos "github.com/eoscanada/eos-go"
+)
+
+// Ancestry records that paths of edges named EdgeName lead from Ancestor to Descendant, once
+// a closure has been built for the name (see the buildclosure action)
+type Ancestry struct {
+	ID         eos.Uint64      `json:"id"`
+	Ancestor   eos.Checksum256 `json:"ancestor"`
+	Descendant eos.Checksum256 `json:"descendant"`
+	EdgeName   eos.Name        `json:"edge_name"`
+	Paths      eos.Uint64      `json:"paths"`
+	PairKey    eos.Checksum256 `json:"pair_key"`
+}
+
+// GetDescendants returns the ancestry rows of every closure in which node is the ancestor
+func GetDescendants(ctx context.Context, api *eos.API, contract eos.AccountName, node eos.Checksum256) ([]Ancestry, error) {
+	var rows []Ancestry
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "ancestry"
+	request.Index = "3"
+	request.KeyType = "sha256"
+	request.LowerBound = node.String()
+	request.UpperBound = node.String()
+	request.Limit = 1000
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return []Ancestry{}, fmt.Errorf("get table rows %v: %v", node.String(), err)
+	}
+
+	err = response.JSONToStructs(&rows)
+	if err != nil {
+		return []Ancestry{}, fmt.Errorf("json to structs %v: %v", node.String(), err)
+	}
+	return rows, nil
+}
+
+// IsAncestor reads whether a path of edgeName edges leads from ancestor to descendant
+func IsAncestor(ctx context.Context, api *eos.API, contract eos.AccountName,
+	ancestor, descendant eos.Checksum256, edgeName eos.Name) (bool, error) {
+
+	rows, err := GetDescendants(ctx, api, contract, ancestor)
+	if err != nil {
+		return false, err
+	}
+
+	for _, row := range rows {
+		if row.EdgeName == edgeName && row.Descendant.String() == descendant.String() {
+			return true, nil
+		}
+	}
+	return false, nil
+}
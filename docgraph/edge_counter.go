@@ -0,0 +1,70 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+
+	eos "github.com/eoscanada/eos-go"
+)
+
+// EdgeDirection selects the out or in counter of a node
+type EdgeDirection uint8
+
+const (
+	// Out counts edges from the node
+	Out EdgeDirection = 0
+	// In counts edges to the node
+	In EdgeDirection = 1
+)
+
+// EdgeCounter is the number of edges with one name leaving or entering a node, kept once the
+// degree counters have been rebuilt (see the rebuilddeg action)
+type EdgeCounter struct {
+	ID        eos.Uint64      `json:"id"`
+	Node      eos.Checksum256 `json:"node"`
+	EdgeName  eos.Name        `json:"edge_name"`
+	Direction EdgeDirection   `json:"direction"`
+	Count     eos.Uint64      `json:"count"`
+}
+
+// GetEdgeCounters returns every counter of a node
+func GetEdgeCounters(ctx context.Context, api *eos.API, contract eos.AccountName, node eos.Checksum256) ([]EdgeCounter, error) {
+	var counters []EdgeCounter
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "edgecounts"
+	request.Index = "3"
+	request.KeyType = "sha256"
+	request.LowerBound = node.String()
+	request.UpperBound = node.String()
+	request.Limit = 1000
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return []EdgeCounter{}, fmt.Errorf("get table rows %v: %v", node.String(), err)
+	}
+
+	err = response.JSONToStructs(&counters)
+	if err != nil {
+		return []EdgeCounter{}, fmt.Errorf("json to structs %v: %v", node.String(), err)
+	}
+	return counters, nil
+}
+
+// GetDegree returns the number of edges named edgeName leaving or entering a node
+func GetDegree(ctx context.Context, api *eos.API, contract eos.AccountName,
+	node eos.Checksum256, edgeName eos.Name, direction EdgeDirection) (uint64, error) {
+
+	counters, err := GetEdgeCounters(ctx, api, contract, node)
+	if err != nil {
+		return 0, err
+	}
+
+	for _, counter := range counters {
+		if counter.EdgeName == edgeName && counter.Direction == direction {
+			return uint64(counter.Count), nil
+		}
+	}
+	return 0, nil
+}
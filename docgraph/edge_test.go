@@ -2,6 +2,7 @@ package docgraph_test
 
 import (
 	"log"
+	"math"
 	"testing"
 
 	eostest "github.com/digital-scarcity/eos-go-test"
@@ -204,3 +205,610 @@ func TestRemoveEdges(t *testing.T) {
 	// assert.Equal(t, len(allEdges), 0)
 	// // *****************************  END
 }
+
+func TestMigrateEdgeKeys(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 4)
+	for i := 0; i < 4; i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	for i := 1; i < 4; i++ {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[0].Hash, docs[i].Hash, "test")
+		assert.NilError(t, err)
+	}
+
+	// migrate one edge per action; rows already re-keyed are revisited, so allow extra rounds
+	for i := 1; i <= 8; i++ {
+		_, err = RunBatch(env.ctx, &env.api, env.Docs, "migedgekeys", 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+
+		// edges must stay readable while the table holds both key versions
+		edgesFrom, err := docgraph.GetEdgesFromDocumentWithEdge(env.ctx, &env.api, env.Docs, docs[0], eos.Name("test"))
+		assert.NilError(t, err)
+		assert.Equal(t, 3, len(edgesFrom))
+	}
+
+	// edges created after the migration use the new keys and can still be removed
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[1].Hash, docs[2].Hash, "test")
+	assert.NilError(t, err)
+
+	allEdges, err := docgraph.GetAllEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(allEdges), 4)
+
+	for i := 1; i < 4; i++ {
+		checkEdge(t, env, docs[0], docs[i], eos.Name("test"))
+		_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[0].Hash, docs[i].Hash, eos.Name("test"))
+		assert.NilError(t, err)
+	}
+
+	_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[1].Hash, docs[2].Hash, eos.Name("test"))
+	assert.NilError(t, err)
+}
+
+func TestMigrateNodeIds(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 4)
+	for i := 0; i < 4; i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	for i := 1; i < 4; i++ {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[0].Hash, docs[i].Hash, "test")
+		assert.NilError(t, err)
+	}
+
+	// move one edge per action; the last round finds the edges table empty
+	for i := 1; i <= 4; i++ {
+		_, err = RunBatch(env.ctx, &env.api, env.Docs, "mignodeids", 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+
+	allEdges, err := docgraph.GetAllEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(allEdges), 0)
+
+	// edges created after the migration go to the node edges table as well
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[1].Hash, docs[2].Hash, "test")
+	assert.NilError(t, err)
+
+	nodes := make([]docgraph.DocumentNode, 4)
+	for i := 0; i < 4; i++ {
+		nodes[i], err = docgraph.LoadDocumentNode(env.ctx, &env.api, env.Docs, docs[i].Hash)
+		assert.NilError(t, err)
+	}
+
+	nodeEdges, err := docgraph.GetAllNodeEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(nodeEdges), 4)
+	for _, edge := range nodeEdges {
+		if edge.FromNode == nodes[0].ID {
+			assert.Assert(t, edge.ToNode != nodes[0].ID)
+		} else {
+			assert.Equal(t, edge.FromNode, nodes[1].ID)
+			assert.Equal(t, edge.ToNode, nodes[2].ID)
+		}
+	}
+
+	for i := 1; i < 4; i++ {
+		_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[0].Hash, docs[i].Hash, eos.Name("test"))
+		assert.NilError(t, err)
+	}
+
+	_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[1].Hash, docs[2].Hash, eos.Name("test"))
+	assert.NilError(t, err)
+
+	nodeEdges, err = docgraph.GetAllNodeEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(nodeEdges), 0)
+}
+
+func TestEdgeRange(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	from, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+	assert.NilError(t, err)
+
+	createEdges := func(count int, edgeName eos.Name) {
+		for i := 0; i < count; i++ {
+			to, err := CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+			assert.NilError(t, err)
+			_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], from.Hash, to.Hash, edgeName)
+			assert.NilError(t, err)
+		}
+	}
+	createEdges(7, "link")
+	createEdges(1, "other")
+
+	// pages smaller than, equal to and larger than the range
+	for pageSize := uint64(1); pageSize <= 8; pageSize++ {
+		_, err = EdgeRangeTest(env.ctx, &env.api, env.Docs, from, "link", pageSize, 7)
+		assert.NilError(t, err)
+	}
+
+	_, err = EdgeRangeTest(env.ctx, &env.api, env.Docs, from, "link", 2, 6)
+	assert.ErrorContains(t, err, "expected 6")
+
+	// part way through the node id migration, the range reads nodeedges first, then edges
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "mignodeids", 4)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	createEdges(2, "link")
+
+	edges, err := docgraph.GetAllEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Assert(t, len(edges) > 0)
+	nodeEdges, err := docgraph.GetAllNodeEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Assert(t, len(nodeEdges) > 0)
+
+	for pageSize := uint64(1); pageSize <= 10; pageSize++ {
+		_, err = EdgeRangeTest(env.ctx, &env.api, env.Docs, from, "link", pageSize, 9)
+		assert.NilError(t, err)
+	}
+}
+
+func TestGraphTraversal(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 7)
+	for i := 0; i < len(docs); i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	// 0 -> 1, 2, 3; 1 -> 4, 5; 4 -> 6; and back from 6 to 0
+	links := [][2]int{{0, 1}, {0, 2}, {0, 3}, {1, 4}, {1, 5}, {4, 6}, {6, 0}}
+	for _, link := range links {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[link[0]].Hash, docs[link[1]].Hash, "link")
+		assert.NilError(t, err)
+	}
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[2].Hash, docs[5].Hash, "other")
+	assert.NilError(t, err)
+
+	// a separate graph where depth-first reaches T or S over three hops before it reaches it over
+	// two: 0 -> A, B; A -> T, V; B -> U, S; U -> T; V -> S; T -> Z; S -> W
+	deep := make([]docgraph.Document, 9)
+	for i := 0; i < len(deep); i++ {
+		deep[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+	deepLinks := [][2]int{{0, 1}, {0, 2}, {1, 3}, {1, 6}, {2, 4}, {2, 5}, {4, 3}, {6, 5}, {3, 7}, {5, 8}}
+	for _, link := range deepLinks {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], deep[link[0]].Hash, deep[link[1]].Hash, "link")
+		assert.NilError(t, err)
+	}
+
+	unlimited := uint64(math.MaxUint64)
+	link := []eos.Name{"link"}
+	// "link" at the first hop, "other" after that
+	linkThenOther := []eos.Name{"link", "other"}
+	breadthFirst, depthFirst := uint8(0), uint8(1)
+
+	// a budget of 1 returns a token after every row read, resumed from its serialized form
+	for _, order := range []uint8{breadthFirst, depthFirst} {
+		for _, budget := range []uint64{1, 2, 3, unlimited} {
+			t.Log("Traversing in order: ", order, " with budget: ", budget)
+
+			// the depth limit; the edge back to the start node is read but reaches nothing new
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 1, unlimited, budget, 0, 3)
+			assert.NilError(t, err)
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 2, unlimited, budget, 0, 5)
+			assert.NilError(t, err)
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 3, unlimited, budget, 0, 6)
+			assert.NilError(t, err)
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 8, unlimited, budget, 0, 6)
+			assert.NilError(t, err)
+
+			// max_visited counts the start node
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 3, 4, budget, 0, 3)
+			assert.NilError(t, err)
+
+			// the visitor stopping early
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 3, unlimited, budget, 2, 2)
+			assert.NilError(t, err)
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 3, unlimited, budget, 5, 5)
+			assert.NilError(t, err)
+
+			// per hop edge names: 1, 2 and 3 over "link", then 5 over "other" from 2
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], linkThenOther, order, 1, unlimited, budget, 0, 3)
+			assert.NilError(t, err)
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], linkThenOther, order, 3, unlimited, budget, 0, 4)
+			assert.NilError(t, err)
+
+			// Z and W are three hops away, so they are only reached through T and S at two hops
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, deep[0], link, order, 3, unlimited, budget, 0, 8)
+			assert.NilError(t, err)
+			_, err = TraversalTest(env.ctx, &env.api, env.Docs, deep[0], link, order, 2, unlimited, budget, 0, 6)
+			assert.NilError(t, err)
+		}
+	}
+
+	_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, breadthFirst, 3, unlimited, 1, 0, 5)
+	assert.ErrorContains(t, err, "reached 6 nodes, expected 5")
+
+	// the same over node ids
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "mignodeids", 100)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	for _, order := range []uint8{breadthFirst, depthFirst} {
+		_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 3, unlimited, 1, 0, 6)
+		assert.NilError(t, err)
+		_, err = TraversalTest(env.ctx, &env.api, env.Docs, docs[0], link, order, 3, 4, 2, 0, 3)
+		assert.NilError(t, err)
+		_, err = TraversalTest(env.ctx, &env.api, env.Docs, deep[0], link, order, 3, unlimited, 1, 0, 8)
+		assert.NilError(t, err)
+	}
+}
+
+func TestFindPath(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 7)
+	for i := 0; i < len(docs); i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+	a, b, c, d, e, x, f := docs[0], docs[1], docs[2], docs[3], docs[4], docs[5], docs[6]
+
+	edges := []struct {
+		from, to docgraph.Document
+		name     eos.Name
+	}{
+		{a, b, "link"}, {a, c, "link"}, {c, d, "link"}, {d, e, "link"},
+		// a cycle between c and d
+		{d, c, "link"},
+		// a shorter way to e, through an edge name that is not always allowed
+		{a, x, "blocked"}, {x, e, "link"},
+		// and back to a
+		{e, f, "back"}, {f, a, "back"},
+	}
+	for _, edge := range edges {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], edge.from.Hash, edge.to.Hash, edge.name)
+		assert.NilError(t, err)
+	}
+
+	link := []eos.Name{"link"}
+	checkPaths := func() {
+		// a direct edge
+		_, err = PathTest(env.ctx, &env.api, env.Docs, a, b, link, 5, true, 1)
+		assert.NilError(t, err)
+
+		// multi-hop paths out of a and back into it
+		_, err = PathTest(env.ctx, &env.api, env.Docs, a, e, link, 5, true, 3)
+		assert.NilError(t, err)
+		_, err = PathTest(env.ctx, &env.api, env.Docs, e, a, []eos.Name{"back"}, 5, true, 2)
+		assert.NilError(t, err)
+		_, err = PathTest(env.ctx, &env.api, env.Docs, e, a, link, 5, false, 0)
+		assert.NilError(t, err)
+
+		// longer than max_hops
+		_, err = PathTest(env.ctx, &env.api, env.Docs, a, e, link, 3, true, 3)
+		assert.NilError(t, err)
+		_, err = PathTest(env.ctx, &env.api, env.Docs, a, e, link, 2, false, 0)
+		assert.NilError(t, err)
+
+		// edge names outside the allow-list are not followed
+		_, err = PathTest(env.ctx, &env.api, env.Docs, a, e, []eos.Name{"link", "blocked"}, 5, true, 2)
+		assert.NilError(t, err)
+
+		// through and around the cycle
+		_, err = PathTest(env.ctx, &env.api, env.Docs, c, e, link, 5, true, 2)
+		assert.NilError(t, err)
+		_, err = PathTest(env.ctx, &env.api, env.Docs, d, b, link, 10, false, 0)
+		assert.NilError(t, err)
+
+		_, err = PathTest(env.ctx, &env.api, env.Docs, a, a, link, 5, true, 0)
+		assert.NilError(t, err)
+	}
+	checkPaths()
+
+	_, err = PathTest(env.ctx, &env.api, env.Docs, a, e, link, 5, true, 2)
+	assert.ErrorContains(t, err, "path has 3 edges, expected 2")
+	_, err = PathTest(env.ctx, &env.api, env.Docs, a, e, link, 2, true, 2)
+	assert.ErrorContains(t, err, "not reachable")
+
+	// the same over node ids
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "mignodeids", 100)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	checkPaths()
+}
+
+func TestReplaceNode(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 8)
+	for i := 0; i < len(docs); i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	// an edge from the node to itself is one row, re-pointed at both ends
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[0].Hash, docs[0].Hash, "self")
+	assert.NilError(t, err)
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[0].Hash, docs[1].Hash, "link")
+	assert.NilError(t, err)
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[2].Hash, docs[0].Hash, "link")
+	assert.NilError(t, err)
+
+	_, err = ReplaceNodeTest(env.ctx, &env.api, env.Docs, docs[0], docs[3], 3)
+	assert.NilError(t, err)
+
+	checkEdge(t, env, docs[3], docs[3], "self")
+	checkEdge(t, env, docs[3], docs[1], "link")
+	checkEdge(t, env, docs[2], docs[3], "link")
+
+	// the new node already has the edge the old one would be re-pointed to
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[4].Hash, docs[1].Hash, "link")
+	assert.NilError(t, err)
+
+	_, err = ReplaceNodeTest(env.ctx, &env.api, env.Docs, docs[4], docs[3], 1)
+	assert.ErrorContains(t, err, "already exists")
+	checkEdge(t, env, docs[4], docs[1], "link")
+
+	// with node ids, a new node that has edges of its own keeps its id and takes over the edges
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "mignodeids", 10)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[5].Hash, docs[5].Hash, "self")
+	assert.NilError(t, err)
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[5].Hash, docs[1].Hash, "link")
+	assert.NilError(t, err)
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[7].Hash, docs[5].Hash, "link")
+	assert.NilError(t, err)
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[6].Hash, docs[7].Hash, "link")
+	assert.NilError(t, err)
+
+	newNode, err := docgraph.LoadDocumentNode(env.ctx, &env.api, env.Docs, docs[6].Hash)
+	assert.NilError(t, err)
+
+	_, err = ReplaceNodeTest(env.ctx, &env.api, env.Docs, docs[5], docs[6], 3)
+	assert.NilError(t, err)
+
+	_, err = docgraph.LoadDocumentNode(env.ctx, &env.api, env.Docs, docs[5].Hash)
+	assert.ErrorContains(t, err, "document node not found")
+
+	otherNode, err := docgraph.LoadDocumentNode(env.ctx, &env.api, env.Docs, docs[7].Hash)
+	assert.NilError(t, err)
+
+	nodeEdges, err := docgraph.GetAllNodeEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	touching := 0
+	for _, edge := range nodeEdges {
+		if edge.FromNode == newNode.ID || edge.ToNode == newNode.ID {
+			touching++
+		}
+		if edge.EdgeName == eos.Name("self") && edge.FromNode == newNode.ID {
+			assert.Equal(t, edge.ToNode, newNode.ID)
+		}
+		if edge.FromNode == otherNode.ID {
+			assert.Equal(t, edge.ToNode, newNode.ID)
+		}
+	}
+	// the three re-pointed edges and the one the new node had before
+	assert.Equal(t, touching, 4)
+
+	// re-pointing onto an edge the new node already has fails in node id mode as well
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[2].Hash, docs[7].Hash, "link")
+	assert.NilError(t, err)
+
+	_, err = ReplaceNodeTest(env.ctx, &env.api, env.Docs, docs[2], docs[6], 1)
+	assert.ErrorContains(t, err, "already exists")
+}
+
+func TestRebuildDegrees(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 4)
+	for i := 0; i < 4; i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	for i := 1; i < 4; i++ {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[0].Hash, docs[i].Hash, "test")
+		assert.NilError(t, err)
+	}
+
+	// count one edge per action, with an edge added and one removed part way through
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "rebuilddeg", 1)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[1].Hash, docs[0].Hash, "test")
+	assert.NilError(t, err)
+
+	_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[0].Hash, docs[3].Hash, eos.Name("test"))
+	assert.NilError(t, err)
+
+	for i := 0; i < 4; i++ {
+		_, err = RunBatch(env.ctx, &env.api, env.Docs, "rebuilddeg", 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+
+	out, err := docgraph.GetDegree(env.ctx, &env.api, env.Docs, docs[0].Hash, eos.Name("test"), docgraph.Out)
+	assert.NilError(t, err)
+	assert.Equal(t, out, uint64(2))
+
+	in, err := docgraph.GetDegree(env.ctx, &env.api, env.Docs, docs[0].Hash, eos.Name("test"), docgraph.In)
+	assert.NilError(t, err)
+	assert.Equal(t, in, uint64(1))
+
+	// counters follow later edges and are removed with the last edge
+	_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[1].Hash, docs[0].Hash, eos.Name("test"))
+	assert.NilError(t, err)
+
+	counters, err := docgraph.GetEdgeCounters(env.ctx, &env.api, env.Docs, docs[1].Hash)
+	assert.NilError(t, err)
+	assert.Equal(t, len(counters), 1)
+	assert.Equal(t, counters[0].Direction, docgraph.In)
+	assert.Equal(t, uint64(counters[0].Count), uint64(1))
+}
+
+func TestBuildEdgeTimes(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 4)
+	for i := 0; i < 4; i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "mignodeids", 10)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	for i := 1; i < 4; i++ {
+		_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[i].Hash, docs[0].Hash, "vote")
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+
+	// index one edge per action, with an edge removed part way through
+	_, err = RunBatch(env.ctx, &env.api, env.Docs, "idxedgetimes", 1)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[1].Hash, docs[0].Hash, eos.Name("vote"))
+	assert.NilError(t, err)
+
+	for i := 0; i < 3; i++ {
+		_, err = RunBatch(env.ctx, &env.api, env.Docs, "idxedgetimes", 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+
+	nodeEdges, err := docgraph.GetAllNodeEdges(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+
+	times, err := docgraph.GetAllEdgeTimes(env.ctx, &env.api, env.Docs)
+	assert.NilError(t, err)
+	assert.Equal(t, len(times), 2)
+	assert.Equal(t, len(times), len(nodeEdges))
+	for i, edgeTime := range times {
+		assert.Equal(t, edgeTime.ID, nodeEdges[i].ID)
+		assert.Equal(t, edgeTime.CreatedDate, nodeEdges[i].CreatedDate)
+	}
+}
+
+func TestBuildClosure(t *testing.T) {
+
+	teardownTestCase := setupTestCase(t)
+	defer teardownTestCase(t)
+
+	env = SetupEnvironment(t)
+	t.Log("\nEnvironment Setup complete\n")
+
+	var err error
+	docs := make([]docgraph.Document, 4)
+	for i := 0; i < 4; i++ {
+		docs[i], err = CreateRandomDocument(env.ctx, &env.api, env.Docs, env.Creators[1])
+		assert.NilError(t, err)
+	}
+
+	// a chain 0 -> 1 -> 2, partly written while the closure is built
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[0].Hash, docs[1].Hash, "parent")
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	_, err = BuildClosure(env.ctx, &env.api, env.Docs, eos.Name("parent"), 10, 1)
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[1].Hash, docs[2].Hash, "parent")
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	for i := 0; i < 2; i++ {
+		_, err = BuildClosure(env.ctx, &env.api, env.Docs, eos.Name("parent"), 10, 1)
+		assert.NilError(t, err)
+		eostest.Pause(chainResponsePause, "Build block...", "")
+	}
+
+	isAncestor, err := docgraph.IsAncestor(env.ctx, &env.api, env.Docs, docs[0].Hash, docs[2].Hash, eos.Name("parent"))
+	assert.NilError(t, err)
+	assert.Assert(t, isAncestor)
+
+	isAncestor, err = docgraph.IsAncestor(env.ctx, &env.api, env.Docs, docs[2].Hash, docs[0].Hash, eos.Name("parent"))
+	assert.NilError(t, err)
+	assert.Assert(t, !isAncestor)
+
+	// closing the cycle is refused
+	_, err = docgraph.CreateEdge(env.ctx, &env.api, env.Docs, env.Creators[1], docs[2].Hash, docs[0].Hash, "parent")
+	assert.ErrorContains(t, err, "would close a cycle")
+
+	// removing the middle edge removes the ancestry through it
+	_, err = docgraph.RemoveEdge(env.ctx, &env.api, env.Docs, docs[1].Hash, docs[2].Hash, eos.Name("parent"))
+	assert.NilError(t, err)
+	eostest.Pause(chainResponsePause, "Build block...", "")
+
+	isAncestor, err = docgraph.IsAncestor(env.ctx, &env.api, env.Docs, docs[0].Hash, docs[2].Hash, eos.Name("parent"))
+	assert.NilError(t, err)
+	assert.Assert(t, !isAncestor)
+
+	descendants, err := docgraph.GetDescendants(env.ctx, &env.api, env.Docs, docs[0].Hash)
+	assert.NilError(t, err)
+	assert.Equal(t, len(descendants), 1)
+	assert.Equal(t, descendants[0].Descendant.String(), docs[1].Hash.String())
+	assert.Equal(t, descendants[0].Paths, eos.Uint64(1))
+}
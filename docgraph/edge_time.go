@@ -0,0 +1,67 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+
+	eos "github.com/eoscanada/eos-go"
+)
+
+// EdgeTime orders the node id edges of a node by creation time once the edge time index
+// has been built (see the idxedgetimes action); its id is the id of the NodeEdge
+type EdgeTime struct {
+	ID          eos.Uint64         `json:"id"`
+	FromNode    eos.Uint64         `json:"from_node"`
+	ToNode      eos.Uint64         `json:"to_node"`
+	EdgeName    eos.Name           `json:"edge_name"`
+	CreatedDate eos.BlockTimestamp `json:"created_date"`
+}
+
+func getEdgeTimeRange(ctx context.Context, api *eos.API, contract eos.AccountName, id uint64, count int) ([]EdgeTime, bool, error) {
+	var times []EdgeTime
+	var request eos.GetTableRowsRequest
+
+	if id > 0 {
+		request.LowerBound = strconv.FormatUint(id, 10)
+	}
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "edgetimes"
+	request.Limit = uint32(count)
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return []EdgeTime{}, false, fmt.Errorf("retrieving edge time range %v", err)
+	}
+
+	err = response.JSONToStructs(&times)
+	if err != nil {
+		return []EdgeTime{}, false, fmt.Errorf("edge time json to structs %v", err)
+	}
+	return times, response.More, nil
+}
+
+// GetAllEdgeTimes reads all rows of the edge time index
+func GetAllEdgeTimes(ctx context.Context, api *eos.API, contract eos.AccountName) ([]EdgeTime, error) {
+
+	var allTimes []EdgeTime
+
+	batchSize := 1000
+
+	batch, more, err := getEdgeTimeRange(ctx, api, contract, 0, batchSize)
+	if err != nil {
+		return []EdgeTime{}, fmt.Errorf("cannot get initial range of edge times %v", err)
+	}
+	allTimes = append(allTimes, batch...)
+
+	for more {
+		batch, more, err = getEdgeTimeRange(ctx, api, contract, uint64(batch[len(batch)-1].ID)+1, batchSize)
+		if err != nil {
+			return []EdgeTime{}, fmt.Errorf("cannot get range of edge times %v", err)
+		}
+		allTimes = append(allTimes, batch...)
+	}
+
+	return allTimes, nil
+}
@@ -0,0 +1,44 @@
+package docgraph
+
+import (
+	"context"
+
+	eostest "github.com/digital-scarcity/eos-go-test"
+	eos "github.com/eoscanada/eos-go"
+)
+
+// GraphOperation is one step of a batch action. Type is create, newedge, removeedge or
+// erase; FromOp and ToOp refer to a document created by an earlier operation of the batch
+// and take the place of FromNode and ToNode
+type GraphOperation struct {
+	Type          eos.Name        `json:"type"`
+	Creator       eos.Name        `json:"creator"`
+	ContentGroups []ContentGroup  `json:"content_groups"`
+	FromNode      eos.Checksum256 `json:"from_node"`
+	ToNode        eos.Checksum256 `json:"to_node"`
+	EdgeName      eos.Name        `json:"edge_name"`
+	FromOp        *uint32         `json:"from_op" eos:"optional"`
+	ToOp          *uint32         `json:"to_op" eos:"optional"`
+}
+
+type applyBatch struct {
+	Operations []GraphOperation `json:"operations"`
+}
+
+// ApplyBatch runs the operations in order within a single action
+func ApplyBatch(ctx context.Context, api *eos.API,
+	contract, actor eos.AccountName,
+	operations []GraphOperation) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("batch"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: actor, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(applyBatch{
+			Operations: operations,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
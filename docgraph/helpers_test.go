@@ -103,13 +103,24 @@ type empty struct {
 	Test string `json:"test"`
 }
 
-// GetAssetTest creates a document with a single random value
+// GetAssetTest checks the asset read through Document and ContentWrapper
 func GetAssetTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document,
 	groupLabel, contentLabel string, contentValue eos.Asset) (string, error) {
+	return getAssetAction(ctx, api, contract, "testgetasset", d, groupLabel, contentLabel, contentValue)
+}
+
+// ViewAssetTest checks the asset read through DocumentView, which must match the Document read
+func ViewAssetTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document,
+	groupLabel, contentLabel string, contentValue eos.Asset) (string, error) {
+	return getAssetAction(ctx, api, contract, "testviewast", d, groupLabel, contentLabel, contentValue)
+}
+
+func getAssetAction(ctx context.Context, api *eos.API, contract eos.AccountName, action string, d docgraph.Document,
+	groupLabel, contentLabel string, contentValue eos.Asset) (string, error) {
 
 	actions := []*eos.Action{{
 		Account: contract,
-		Name:    eos.ActN("testgetasset"),
+		Name:    eos.ActN(action),
 		Authorization: []eos.PermissionLevel{
 			{Actor: contract, Permission: eos.PN("active")},
 		},
@@ -129,14 +140,23 @@ type getGroup struct {
 }
 
 func GetGroupTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document, groupLabel string) (string, error) {
+	return getGroupAction(ctx, api, contract, "testgetgroup", d, groupLabel)
+}
+
+// ViewGroupTest reads the group through DocumentView, which must match the Document read
+func ViewGroupTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document, groupLabel string) (string, error) {
+	return getGroupAction(ctx, api, contract, "testviewgrp", d, groupLabel)
+}
+
+func getGroupAction(ctx context.Context, api *eos.API, contract eos.AccountName, action string, d docgraph.Document, groupLabel string) (string, error) {
 
 	actions := []*eos.Action{{
 		Account: contract,
-		Name:    eos.ActN("testgetgroup"),
+		Name:    eos.ActN(action),
 		Authorization: []eos.PermissionLevel{
 			{Actor: contract, Permission: eos.PN("active")},
 		},
-		ActionData: eos.NewActionData(getAsset{
+		ActionData: eos.NewActionData(getGroup{
 			Hash:       d.Hash,
 			GroupLabel: groupLabel,
 		}),
@@ -144,6 +164,80 @@ func GetGroupTest(ctx context.Context, api *eos.API, contract eos.AccountName, d
 	return eostest.ExecWithRetry(ctx, api, actions)
 }
 
+type indexedTest struct {
+	Hash eos.Checksum256 `json:"hash"`
+}
+
+// IndexedTest edits the document's groups through a plain and an indexed ContentWrapper; the
+// action fails if the two find different groups or items after any edit
+func IndexedTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testindexed"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(indexedTest{
+			Hash: d.Hash,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type getFields struct {
+	Hash        eos.Checksum256 `json:"hash"`
+	GroupLabel  string          `json:"groupLabel"`
+	FirstAsset  string          `json:"firstAsset"`
+	NameLabel   string          `json:"nameLabel"`
+	SecondAsset string          `json:"secondAsset"`
+	Indexed     bool            `json:"indexed"`
+}
+
+// GetFieldsTest reads an asset, a name and an asset from the group with one getFieldsOrFail
+// call, through an indexed ContentWrapper if indexed is set
+func GetFieldsTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document,
+	groupLabel, firstAsset, nameLabel, secondAsset string, indexed bool) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testfields"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(getFields{
+			Hash:        d.Hash,
+			GroupLabel:  groupLabel,
+			FirstAsset:  firstAsset,
+			NameLabel:   nameLabel,
+			SecondAsset: secondAsset,
+			Indexed:     indexed,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type schemaTest struct {
+	Hash eos.Checksum256 `json:"hash"`
+}
+
+// SchemaTest decodes the labelled group of an each-type document through a DocumentSchema and
+// checks that encoding it gives the group back
+func SchemaTest(ctx context.Context, api *eos.API, contract eos.AccountName, d docgraph.Document) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testschema"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(schemaTest{
+			Hash: d.Hash,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
 func ContentError(ctx context.Context, api *eos.API, contract eos.AccountName) (string, error) {
 	actions := []*eos.Action{{
 		Account: contract,
@@ -158,6 +252,178 @@ func ContentError(ctx context.Context, api *eos.API, contract eos.AccountName) (
 	return eostest.ExecTrx(ctx, api, actions)
 }
 
+type edgeRangeTest struct {
+	Node          eos.Checksum256 `json:"node"`
+	EdgeName      eos.Name        `json:"edge_name"`
+	PageSize      uint64          `json:"page_size"`
+	ExpectedCount uint64          `json:"expected_count"`
+}
+
+// EdgeRangeTest walks the edgeName edges from node in pages of pageSize; the action fails
+// unless the pages add up to expectedCount edges in the order of a single walk
+func EdgeRangeTest(ctx context.Context, api *eos.API, contract eos.AccountName,
+	node docgraph.Document, edgeName eos.Name, pageSize, expectedCount uint64) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testrange"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(edgeRangeTest{
+			Node:          node.Hash,
+			EdgeName:      edgeName,
+			PageSize:      pageSize,
+			ExpectedCount: expectedCount,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type traversalTest struct {
+	Start         eos.Checksum256 `json:"start"`
+	EdgeNames     []eos.Name      `json:"edge_names"`
+	Order         uint8           `json:"order"`
+	MaxDepth      uint32          `json:"max_depth"`
+	MaxVisited    uint64          `json:"max_visited"`
+	Budget        uint64          `json:"budget"`
+	StopAfter     uint64          `json:"stop_after"`
+	ExpectedNodes uint64          `json:"expected_nodes"`
+}
+
+// TraversalTest traverses from start in order (0 breadth-first, 1 depth-first), following
+// edgeNames[i] at hop i and the last name after that, resuming after every budget rows; the
+// action fails unless expectedNodes nodes were reached, the same as without a budget and, when
+// nothing stopped it early, at the same depths as breadth-first
+func TraversalTest(ctx context.Context, api *eos.API, contract eos.AccountName,
+	start docgraph.Document, edgeNames []eos.Name, order uint8, maxDepth uint32, maxVisited, budget, stopAfter, expectedNodes uint64) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testtraverse"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(traversalTest{
+			Start:         start.Hash,
+			EdgeNames:     edgeNames,
+			Order:         order,
+			MaxDepth:      maxDepth,
+			MaxVisited:    maxVisited,
+			Budget:        budget,
+			StopAfter:     stopAfter,
+			ExpectedNodes: expectedNodes,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type pathTest struct {
+	FromNode     eos.Checksum256 `json:"from_node"`
+	ToNode       eos.Checksum256 `json:"to_node"`
+	EdgeNames    []eos.Name      `json:"edge_names"`
+	MaxHops      uint32          `json:"max_hops"`
+	Reachable    bool            `json:"reachable"`
+	ExpectedHops uint32          `json:"expected_hops"`
+}
+
+// PathTest searches a path from fromNode to toNode over edgeNames; the action fails unless
+// one was found as reachable says, made of expectedHops such edges
+func PathTest(ctx context.Context, api *eos.API, contract eos.AccountName,
+	fromNode, toNode docgraph.Document, edgeNames []eos.Name, maxHops uint32, reachable bool, expectedHops uint32) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testpath"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(pathTest{
+			FromNode:     fromNode.Hash,
+			ToNode:       toNode.Hash,
+			EdgeNames:    edgeNames,
+			MaxHops:      maxHops,
+			Reachable:    reachable,
+			ExpectedHops: expectedHops,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type replaceNodeTest struct {
+	OldNode      eos.Checksum256 `json:"old_node"`
+	NewNode      eos.Checksum256 `json:"new_node"`
+	ExpectedRows uint64          `json:"expected_rows"`
+}
+
+// ReplaceNodeTest re-points the edges of oldNode to newNode; the action fails unless
+// expectedRows edge rows were rewritten
+func ReplaceNodeTest(ctx context.Context, api *eos.API, contract eos.AccountName,
+	oldNode, newNode docgraph.Document, expectedRows uint64) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testreplace"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(replaceNodeTest{
+			OldNode:      oldNode.Hash,
+			NewNode:      newNode.Hash,
+			ExpectedRows: expectedRows,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type cacheTest struct {
+	Hash   eos.Checksum256         `json:"hash"`
+	First  []docgraph.ContentGroup `json:"first"`
+	Second []docgraph.ContentGroup `json:"second"`
+}
+
+// CacheTest updates the document twice and erases the result within one action
+func CacheTest(ctx context.Context, api *eos.API, contract eos.AccountName, hash eos.Checksum256,
+	first, second []docgraph.ContentGroup) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testcache"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(cacheTest{
+			Hash:   hash,
+			First:  first,
+			Second: second,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type diffTest struct {
+	Original eos.Checksum256 `json:"original"`
+	Updated  eos.Checksum256 `json:"updated"`
+}
+
+// DiffTest diffs original against updated and merges the deltas into original; the action
+// fails unless that gives the groups of updated
+func DiffTest(ctx context.Context, api *eos.API, contract eos.AccountName, original, updated docgraph.Document) (string, error) {
+
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("testdiff"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(diffTest{
+			Original: original.Hash,
+			Updated:  updated.Hash,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
 func CreateRoot(ctx context.Context, api *eos.API, contract, creator eos.AccountName) (docgraph.Document, error) {
 	actions := []*eos.Action{{
 		Account: contract,
@@ -182,7 +448,7 @@ func CreateRoot(ctx context.Context, api *eos.API, contract, creator eos.Account
 }
 
 // CreateRandomDocument creates a document with a single random value
-func CreateRandomDocument(ctx context.Context, api *eos.API, contract, creator eos.AccountName) (docgraph.Document, error) {
+func randomContentGroups() []docgraph.ContentGroup {
 
 	var ci docgraph.ContentItem
 	ci.Label = randomString()
@@ -197,6 +463,16 @@ func CreateRandomDocument(ctx context.Context, api *eos.API, contract, creator e
 	cg[0] = ci
 	cgs := make([]docgraph.ContentGroup, 1)
 	cgs[0] = cg
+	return cgs
+}
+
+func CreateRandomDocument(ctx context.Context, api *eos.API, contract, creator eos.AccountName) (docgraph.Document, error) {
+	return CreateDocumentFromGroups(ctx, api, contract, creator, randomContentGroups())
+}
+
+// CreateDocumentFromGroups creates a document with the content groups as given
+func CreateDocumentFromGroups(ctx context.Context, api *eos.API, contract, creator eos.AccountName,
+	cgs []docgraph.ContentGroup) (docgraph.Document, error) {
 
 	actions := []*eos.Action{{
 		Account: contract,
@@ -211,7 +487,7 @@ func CreateRandomDocument(ctx context.Context, api *eos.API, contract, creator e
 	}}
 	_, err := eostest.ExecWithRetry(ctx, api, actions)
 	if err != nil {
-		return docgraph.Document{}, fmt.Errorf("execute transaction random document: %v", err)
+		return docgraph.Document{}, fmt.Errorf("execute transaction create document: %v", err)
 	}
 
 	lastDoc, err := docgraph.GetLastDocument(ctx, api, contract)
@@ -298,3 +574,85 @@ func EdgeIdxTest(ctx context.Context, api *eos.API,
 	}}
 	return eostest.ExecWithRetry(ctx, api, actions)
 }
+
+type batchAction struct {
+	BatchSize uint64 `json:"batch_size"`
+}
+
+// RunBatch calls one of the actions that process up to batchSize rows per call and keep
+// their position on chain: migedgekeys, mignodeids, rebuilddeg, idxedgetimes, migdockeys,
+// migdocheads and auditdocs
+func RunBatch(ctx context.Context, api *eos.API, contract eos.AccountName, action string, batchSize uint64) (string, error) {
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN(action),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(batchAction{
+			BatchSize: batchSize,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type buildClosure struct {
+	EdgeName   eos.Name `json:"edge_name"`
+	MaxUpdates uint64   `json:"max_updates"`
+	BatchSize  uint64   `json:"batch_size"`
+}
+
+// BuildClosure keeps an ancestry closure for edgeName and adds up to batchSize existing edges to it
+func BuildClosure(ctx context.Context, api *eos.API, contract eos.AccountName, edgeName eos.Name, maxUpdates, batchSize uint64) (string, error) {
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("buildclosure"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(buildClosure{
+			EdgeName:   edgeName,
+			MaxUpdates: maxUpdates,
+			BatchSize:  batchSize,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type setStorage struct {
+	GroupStorage bool `json:"group_storage"`
+}
+
+// SetStorage selects whether new documents keep their content groups in the docgroups table
+func SetStorage(ctx context.Context, api *eos.API, contract eos.AccountName, groupStorage bool) (string, error) {
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("setstorage"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(setStorage{
+			GroupStorage: groupStorage,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
+
+type setHashVersion struct {
+	HashVersion uint8 `json:"hash_version"`
+}
+
+// SetHashVersion selects the hash version of new documents
+func SetHashVersion(ctx context.Context, api *eos.API, contract eos.AccountName, hashVersion uint8) (string, error) {
+	actions := []*eos.Action{{
+		Account: contract,
+		Name:    eos.ActN("sethashver"),
+		Authorization: []eos.PermissionLevel{
+			{Actor: contract, Permission: eos.PN("active")},
+		},
+		ActionData: eos.NewActionData(setHashVersion{
+			HashVersion: hashVersion,
+		}),
+	}}
+	return eostest.ExecWithRetry(ctx, api, actions)
+}
@@ -0,0 +1,103 @@
+package docgraph
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+
+	eos "github.com/eoscanada/eos-go"
+)
+
+// DocumentNode is the stable id of a document that takes part in edges once the
+// node id migration has started (see the mignodeids action)
+type DocumentNode struct {
+	ID   eos.Uint64      `json:"id"`
+	Hash eos.Checksum256 `json:"hash"`
+}
+
+// NodeEdge is an edge between two document node ids
+type NodeEdge struct {
+	ID          eos.Uint64         `json:"id"`
+	FromNode    eos.Uint64         `json:"from_node"`
+	ToNode      eos.Uint64         `json:"to_node"`
+	EdgeName    eos.Name           `json:"edge_name"`
+	CreatedDate eos.BlockTimestamp `json:"created_date"`
+	Creator     eos.Name           `json:"creator"`
+}
+
+// LoadDocumentNode reads the node of the document with the given hash
+func LoadDocumentNode(ctx context.Context, api *eos.API, contract eos.AccountName, hash eos.Checksum256) (DocumentNode, error) {
+	var nodes []DocumentNode
+	var request eos.GetTableRowsRequest
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "docnodes"
+	request.Index = "2"
+	request.KeyType = "sha256"
+	request.LowerBound = hash.String()
+	request.UpperBound = hash.String()
+	request.Limit = 1
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return DocumentNode{}, fmt.Errorf("get table rows %v: %v", hash.String(), err)
+	}
+
+	err = response.JSONToStructs(&nodes)
+	if err != nil {
+		return DocumentNode{}, fmt.Errorf("json to structs %v: %v", hash.String(), err)
+	}
+
+	if len(nodes) == 0 {
+		return DocumentNode{}, fmt.Errorf("document node not found %v", hash.String())
+	}
+	return nodes[0], nil
+}
+
+func getNodeEdgeRange(ctx context.Context, api *eos.API, contract eos.AccountName, id uint64, count int) ([]NodeEdge, bool, error) {
+	var edges []NodeEdge
+	var request eos.GetTableRowsRequest
+
+	if id > 0 {
+		request.LowerBound = strconv.FormatUint(id, 10)
+	}
+	request.Code = string(contract)
+	request.Scope = string(contract)
+	request.Table = "nodeedges"
+	request.Limit = uint32(count)
+	request.JSON = true
+	response, err := api.GetTableRows(ctx, request)
+	if err != nil {
+		return []NodeEdge{}, false, fmt.Errorf("retrieving node edge range %v", err)
+	}
+
+	err = response.JSONToStructs(&edges)
+	if err != nil {
+		return []NodeEdge{}, false, fmt.Errorf("node edge json to structs %v", err)
+	}
+	return edges, response.More, nil
+}
+
+// GetAllNodeEdges reads all edges stored between node ids
+func GetAllNodeEdges(ctx context.Context, api *eos.API, contract eos.AccountName) ([]NodeEdge, error) {
+
+	var allEdges []NodeEdge
+
+	batchSize := 1000
+
+	batch, more, err := getNodeEdgeRange(ctx, api, contract, 0, batchSize)
+	if err != nil {
+		return []NodeEdge{}, fmt.Errorf("cannot get initial range of node edges %v", err)
+	}
+	allEdges = append(allEdges, batch...)
+
+	for more {
+		batch, more, err = getNodeEdgeRange(ctx, api, contract, uint64(batch[len(batch)-1].ID)+1, batchSize)
+		if err != nil {
+			return []NodeEdge{}, fmt.Errorf("cannot get range of node edges %v", err)
+		}
+		allEdges = append(allEdges, batch...)
+	}
+
+	return allEdges, nil
+}
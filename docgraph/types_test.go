@@ -125,7 +125,7 @@ func TestEdgeJSONUnmarshal(t *testing.T) {
 	err := json.Unmarshal([]byte(input), &e)
 
 	require.NoError(t, err)
-	assert.Equal(t, e.ID, uint64(349057277), "id")
+	assert.Equal(t, uint64(e.ID), uint64(349057277), "id")
 	assert.Equal(t, e.EdgeName, eos.Name("memberof"), "edge_name")
 	assert.Equal(t, e.FromNode.String(), string("7463fa7dda551b9c4bbd2ba17b793931c825cefff9eede14461fd1a5c9f07d15"), "from_node")
 	assert.Equal(t, e.ToNode.String(), string("d4ec74355830056924c83f20ffb1a22ad0c5145a96daddf6301897a092de951e"), "to_node")
@@ -137,7 +137,7 @@ func TestDocumentJSONUnmarshal(t *testing.T) {
 	err := json.Unmarshal([]byte(testDocument), &d)
 
 	require.NoError(t, err)
-	assert.Equal(t, d.ID, uint64(24), "id")
+	assert.Equal(t, uint64(d.ID), uint64(24), "id")
 	assert.Equal(t, d.Hash.String(), string("05e81010c4600ed5d978d2ddf22420ffdf6c4094f4b3822711f0596c7c342ccb"), "hash")
 	assert.Equal(t, d.Creator, eos.AN("johnnyhypha1"), "creator")
 	assert.Equal(t, len(d.ContentGroups), 2, "content groups length")
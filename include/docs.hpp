@@ -8,6 +8,8 @@
 #include <eosio/crypto.hpp>
 
 #include <document_graph/document_graph.hpp>
+#include <document_graph/document_schema.hpp>
+#include <document_graph/document_view.hpp>
 
 using namespace eosio;
 
@@ -28,12 +30,54 @@ namespace hypha
       ACTION getornewget(const name &creator, ContentGroups &content_groups);
       ACTION getornewnew(const name &creator, ContentGroups &content_groups);
 
+      // replaces the document with the next version, built from deltas in the merge format;
+      // prints the new hash
+      ACTION mergedoc(const name &updater, const checksum256 &hash, ContentGroups &deltas);
+
       ACTION newedge(eosio::name & creator, const checksum256 &from_node, const checksum256 &to_node, const name &edge_name);
 
       ACTION removeedge(const checksum256 &from_node, const checksum256 &to_node, const name &edge_name);
 
+      // applies create/newedge/removeedge/erase operations in order; prints the created hashes
+      ACTION batch(const std::vector<GraphOperation> &operations);
+
       ACTION erase(const checksum256 &hash);
 
+      // erases the document after removing its edges batch_size at a time; anyone can call
+      // again until it stops printing "pending"
+      ACTION erasebatch(const checksum256 &hash, const uint64_t &batch_size);
+
+      // re-keys up to batch_size edges to the v2 composite keys; call until it stops printing "pending"
+      ACTION migedgekeys(const uint64_t &batch_size);
+
+      // moves up to batch_size documents to hash-derived primary keys; call until it stops printing "pending"
+      ACTION migdockeys(const uint64_t &batch_size);
+
+      // backfills up to batch_size document header rows; call until it stops printing "pending"
+      ACTION migdocheads(const uint64_t &batch_size);
+
+      // moves up to batch_size edges to stable node ids; call until it stops printing "pending"
+      ACTION mignodeids(const uint64_t &batch_size);
+
+      // counts up to batch_size existing edges into the degree counters; call until it stops printing "pending"
+      ACTION rebuilddeg(const uint64_t &batch_size);
+
+      // indexes up to batch_size node id edges by creation time; call until it stops printing "pending"
+      ACTION idxedgetimes(const uint64_t &batch_size);
+
+      // keeps an ancestry closure for edge_name and adds up to batch_size existing edges to it;
+      // call until it stops printing "pending"
+      ACTION buildclosure(const name &edge_name, const uint64_t &max_updates, const uint64_t &batch_size);
+
+      // selects whether new documents keep each content group in its own shared row
+      ACTION setstorage(const bool &group_storage);
+
+      // selects the hash version of new documents: 1 hashes the whole content, 2 is the Merkle hash over groups
+      ACTION sethashver(const uint8_t &hash_version);
+
+      // re-verifies the hashes of up to batch_size documents; call until it stops printing "pending"
+      ACTION auditdocs(const uint64_t &batch_size);
+
       ACTION testgetasset(const checksum256 &hash,
                           const std::string &groupLabel,
                           const std::string &contentLabel,
@@ -42,8 +86,58 @@ namespace hypha
       ACTION testgetgroup(const checksum256 &hash,
                           const std::string &groupLabel);
 
+      // the same reads through DocumentView, checked against Document
+      ACTION testviewast(const checksum256 &hash,
+                         const std::string &groupLabel,
+                         const std::string &contentLabel,
+                         const asset &contentValue);
+
+      ACTION testviewgrp(const checksum256 &hash,
+                         const std::string &groupLabel);
+
       ACTION testcntnterr(string test);
 
+      // applies the same edits through a plain and an indexed ContentWrapper over a stored document
+      // and checks after each edit that both find the same groups and items
+      ACTION testindexed(const checksum256 &hash);
+
+      // reads three items as an asset, a name and an asset in one getFieldsOrFail call, through an
+      // indexed ContentWrapper if indexed is set, and checks each against a getOrFail lookup
+      ACTION testfields(const checksum256 &hash, const std::string &groupLabel,
+                        const std::string &firstAsset, const std::string &nameLabel, const std::string &secondAsset,
+                        const bool &indexed);
+
+      // decodes the first group of an each-type document through a DocumentSchema and checks
+      // that encoding the result gives the group back
+      ACTION testschema(const checksum256 &hash);
+
+      // walks the edge_name edges from node in pages of page_size and checks they match a single walk
+      ACTION testrange(const checksum256 &node, const name &edge_name, const uint64_t &page_size, const uint64_t &expected_count);
+
+      // traverses from start in order (0 breadth-first, 1 depth-first), following edge_names[i]
+      // at hop i and the last name after that, resuming a packed token after every budget rows;
+      // checks the nodes reached against expected_nodes and an unbudgeted traversal, and when
+      // nothing stopped it early, their depths against a breadth-first one
+      ACTION testtraverse(const checksum256 &start, const std::vector<name> &edge_names, const uint8_t &order,
+                          const uint32_t &max_depth, const uint64_t &max_visited, const uint64_t &budget,
+                          const uint64_t &stop_after, const uint64_t &expected_nodes);
+
+      // searches a path of at most max_hops edges named in edge_names and checks whether one was
+      // found, that it is made of such edges from from_node to to_node, and its length
+      ACTION testpath(const checksum256 &from_node, const checksum256 &to_node, const std::vector<name> &edge_names,
+                      const uint32_t &max_hops, const bool &reachable, const uint32_t &expected_hops);
+
+      // re-points the edges of old_node to new_node and checks how many edge rows were rewritten
+      ACTION testreplace(const checksum256 &old_node, const checksum256 &new_node, const uint64_t &expected_rows);
+
+      // updates the document to first and then to second, and erases the result, all through one
+      // DocumentGraph; checks what its document cache saw along the way
+      ACTION testcache(const checksum256 &hash, ContentGroups &first, ContentGroups &second);
+
+      // diffs the groups of original against those of updated, merges the deltas into original
+      // and checks the result has the groups of updated
+      ACTION testdiff(const checksum256 &original, const checksum256 &updated);
+
       // // Fork creates a new document (node in a graph) from an existing document.
       // // The forked content should contain only new or updated entries to avoid data duplication. (lazily enforced?)
       // ACTION fork(const checksum256 &hash, const name &creator, const vector<document_graph::content_group> &content_groups);
@@ -25,6 +25,11 @@ namespace hypha
 
         const std::string toString() const;
 
+        // canonical encoding used for fingerprinting; toString() is built from these, so
+        // callers can size one buffer up front and write many items into it without copies
+        std::size_t canonicalSize() const;
+        char *writeCanonical(char *out) const;
+
         // NOTE: not using m_ notation because this changes serialization format
         std::string label;
         FlexValue value;
@@ -1,7 +1,13 @@
 #pragma once
 #include <document_graph/content.hpp>
 
+#include <algorithm>
+#include <array>
+#include <optional>
 #include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 using std::string;
 using std::string_view;
@@ -18,8 +24,16 @@ namespace hypha
 
     public:
         ContentWrapper(ContentGroups &cgs);
+        // With indexed set, the wrapper sorts the group labels once, and the item labels of a
+        // group the first time it is searched; lookups binary search them instead of scanning.
+        // Changes made through the wrapper keep the index current; after changing the groups any
+        // other way, call reindex().
+        ContentWrapper(ContentGroups &cgs, bool indexed);
         ~ContentWrapper();
 
+        bool isIndexed() const { return m_index.has_value(); }
+        void reindex();
+
         // non-static definitions
         std::pair<int64_t, ContentGroup *> getGroup(const std::string &label);
         std::pair<int64_t, ContentGroup*> getGroupOrCreate(const string& label);
@@ -34,6 +48,19 @@ namespace hypha
         std::pair<int64_t, Content*> getOrFail(size_t groupIndex, const string &contentLabel, string_view error = string_view{});
         
 
+        // Finds the first item with each of the count labels in one pass over the group, setting
+        // the missing ones to nullptr. Returns false if the group does not exist.
+        bool getFields(const std::string &groupLabel, const string_view *labels, Content **fields, size_t count);
+
+        // Reads the items with labels as the types T..., failing once with a message that names
+        // every missing item and every item holding another type:
+        //   auto [title, amount] = cw.getFieldsOrFail<std::string, eosio::asset>("details", {"title", "amount"});
+        template <typename... T>
+        std::tuple<T &...> getFieldsOrFail(const std::string &groupLabel, const std::array<string_view, sizeof...(T)> &labels)
+        {
+            return getFieldsOrFail<T...>(groupLabel, labels, std::index_sequence_for<T...>{});
+        }
+
         void removeGroup(const std::string &groupLabel);
         void removeGroup(size_t groupIndex);
 
@@ -52,10 +79,61 @@ namespace hypha
         static string_view getGroupLabel(const ContentGroup &contentGroup);
         static void insertOrReplace(ContentGroup &contentGroup, const Content &newContent);
 
+        // Fails naming every item that is not valid, as missing unless found, else as mistyped;
+        // items are named by label, or group/label when groups is given
+        static void failItems(const std::string &context, const string_view *groups, const string_view *labels,
+                              const bool *found, const bool *valid, size_t count);
+
         ContentGroups &getContentGroups() { return m_contentGroups; }
 
     private:
+        // Labels are ordered by a 64-bit hash, so sorting and searching compare integers; the
+        // label itself is compared only on a hash match.
+        struct LabelIndex
+        {
+            struct GroupEntry
+            {
+                uint64_t hash;
+                uint32_t group;
+                uint32_t item;
+
+                bool operator<(const GroupEntry &other) const
+                {
+                    return std::tie(hash, group, item) < std::tie(other.hash, other.group, other.item);
+                }
+            };
+
+            // every group label item, ordered by the hash of its value, then position
+            std::vector<GroupEntry> groups;
+            // for each group, the label hash and position of its items in order; empty until the
+            // group is first searched
+            std::vector<std::vector<std::pair<uint64_t, uint32_t>>> items;
+        };
+
+        template <typename... T, size_t... I>
+        std::tuple<T &...> getFieldsOrFail(const std::string &groupLabel, const std::array<string_view, sizeof...(T)> &labels,
+                                           std::index_sequence<I...>)
+        {
+            std::array<Content *, sizeof...(T)> fields;
+            EOS_CHECK(getFields(groupLabel, labels.data(), fields.data(), fields.size()), "group: " + groupLabel + " is required but not found");
+
+            const std::array<bool, sizeof...(T)> found{(fields[I] != nullptr)...};
+            const std::array<bool, sizeof...(T)> typed{(found[I] && std::holds_alternative<T>(fields[I]->value))...};
+            if (std::find(typed.begin(), typed.end(), false) != typed.end())
+            {
+                failItems("group: " + groupLabel, nullptr, labels.data(), found.data(), typed.data(), fields.size());
+            }
+            return std::tuple<T &...>(std::get<T>(fields[I]->value)...);
+        }
+
+        // position of the first item with contentLabel in the group, or -1
+        int64_t indexedItem(size_t groupIndex, string_view contentLabel);
+        const std::string &indexedGroupLabel(const LabelIndex::GroupEntry &entry) const;
+        void indexGroupLabels();
+        void indexItems(size_t groupIndex);
+
         ContentGroups &m_contentGroups;
+        std::optional<LabelIndex> m_index;
     };
 
 } // namespace hypha
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <limits>
+#include <optional>
 #include <variant>
 
 #include <eosio/multi_index.hpp>
@@ -7,9 +9,13 @@
 #include <eosio/asset.hpp>
 #include <eosio/transaction.hpp>
 #include <eosio/crypto.hpp>
+#include <eosio/singleton.hpp>
+#include <eosio/binary_extension.hpp>
 
 #include <document_graph/content.hpp>
 #include <document_graph/content_wrapper.hpp>
+#include <document_graph/document_group.hpp>
+#include <document_graph/document_header.hpp>
 
 namespace hypha
 {
@@ -26,6 +32,76 @@ namespace hypha
         EOSLIB_SERIALIZE(Certificate, (certifier)(notes)(certification_date))
     };
 
+    // Tracks how document primary keys are assigned. Version 1 is the legacy
+    // available_primary_key() sequence, found through the idhash index. Version 2 derives
+    // the key from the content hash so a lookup is one primary probe. While migrating,
+    // lookups that miss the hash-derived key fall back to idhash.
+    struct DocumentKeyState
+    {
+        std::uint8_t key_version = 1;
+        bool migrating = false;
+        std::uint64_t cursor = 0;
+
+        EOSLIB_SERIALIZE(DocumentKeyState, (key_version)(migrating)(cursor))
+    };
+
+    // Selects how new documents are hashed. Version 1 is sha256 over the canonical string of all
+    // content groups. Version 2 hashes each group on its own and makes the document hash the root
+    // of a Merkle tree over those group hashes, which are stored on the row. Each row records its
+    // version, so documents of both versions can share one table.
+    struct DocumentHashState
+    {
+        std::uint8_t hash_version = 1;
+
+        EOSLIB_SERIALIZE(DocumentHashState, (hash_version))
+    };
+
+    // Progress of the integrity audit, which recomputes stored document hashes in batches.
+    // A pass runs from the lowest primary key to the end of the table and keeps its totals
+    // until the next pass starts.
+    struct DocumentAuditState
+    {
+        bool running = false;
+        std::uint64_t cursor = 0;
+        std::uint64_t checked = 0;
+        std::uint64_t mismatches = 0;
+        eosio::checksum256 last_mismatch;
+
+        EOSLIB_SERIALIZE(DocumentAuditState, (running)(cursor)(checked)(mismatches)(last_mismatch))
+    };
+
+    // How a document read from the table treats its stored hash. Verify recomputes the hash
+    // from the content and fails on a mismatch. Trusted takes the stored hash, which was
+    // computed when the row was written; the audit action re-checks rows out of band.
+    enum class LoadMode : std::uint8_t
+    {
+        Verify,
+        Trusted
+    };
+
+    // What Document::mergeInPlace did to the groups of the original document, so callers can
+    // reuse what they derived from the groups it left alone.
+    struct MergeChanges
+    {
+        // marks a group the deltas appended or wrote to
+        static constexpr std::uint32_t CHANGED = std::numeric_limits<std::uint32_t>::max();
+
+        // for each group of the merged document, its position in the original document if the
+        // merge left it as it was, or CHANGED
+        std::vector<std::uint32_t> sources;
+        // the number of original groups the deltas deleted
+        std::uint32_t removed = 0;
+
+        bool changed() const;
+    };
+
+    // contracts opt in to trusted reads by default by compiling with -DDOCUMENT_TRUSTED_READS
+#ifdef DOCUMENT_TRUSTED_READS
+    constexpr LoadMode DEFAULT_LOAD_MODE = LoadMode::Trusted;
+#else
+    constexpr LoadMode DEFAULT_LOAD_MODE = LoadMode::Verify;
+#endif
+
     struct Document
     {
     public:
@@ -38,11 +114,15 @@ namespace hypha
         Document(eosio::name contract, eosio::name creator, const std::string &label, const Content::FlexValue &value);
 
         // this constructor reads the hash from the table and populates the object from storage
-        Document(eosio::name contract, const eosio::checksum256 &hash);
+        Document(eosio::name contract, const eosio::checksum256 &hash, LoadMode mode = DEFAULT_LOAD_MODE);
         ~Document();
 
         void emplace();
 
+        // with group storage, groups listed in releasedGroupKeys are taken over from a document the
+        // caller is about to erase instead of being counted again
+        void emplace(const std::vector<uint64_t> &releasedGroupKeys);
+
         // returns a document, saves to RAM if it doesn't already exist
         static Document getOrNew(eosio::name contract, eosio::name creator, ContentGroups contentGroups);
         static Document getOrNew(eosio::name contract, eosio::name creator, ContentGroup contentGroup);
@@ -51,27 +131,67 @@ namespace hypha
 
         static bool exists(eosio::name contract, const eosio::checksum256 &hash);
 
+        // emplaces contentGroups as the next version of previous; with group storage, the groups
+        // both versions share are handed over rather than rewritten
+        static Document emplaceRevision(const Document &previous, eosio::name creator, ContentGroups contentGroups);
+        // the same with deltas merged into the content of previous, see merge; with version 2
+        // hashes only the groups the deltas touch are rehashed
+        static Document emplaceMerge(const Document &previous, eosio::name creator, const Document &deltas);
+
         // certificates are not yet used
         void certify(const eosio::name &certifier, const std::string &notes);
 
+        // hashes with the version set on this document, see DocumentHashState
         const void hashContents();
 
         // static helpers
+        // the version 1 hash
         static const eosio::checksum256 hashContents(const ContentGroups &contentGroups);
+        static const eosio::checksum256 hashContents(const ContentGroups &contentGroups, std::uint8_t hashVersion);
+        // the hash a new document of contract with this content gets
+        static const eosio::checksum256 hashContents(const eosio::name &contract, const ContentGroups &contentGroups);
         static ContentGroups rollup(ContentGroup contentGroup);
         static ContentGroups rollup(Content content);
         static void insertOrReplace(ContentGroup &contentGroup, Content &newContent);
 
+        // with version 2 hashes, only the groups the deltas touch are rehashed
         static Document merge(Document original, Document &deltas);
+        // the same, applied to original without copying it
+        static MergeChanges mergeInPlace(Document &original, const Document &deltas);
+        // the smallest deltas that merge turns original into updated: a changed group carries its
+        // changed items and a monostate value for each removed one, a dropped group delete_group.
+        // Groups sharing a label are paired in order, after deleting the surplus original ones
+        // from the front; as merge only updates the first of them, when a later pair differs
+        // all are deleted and the updated ones appended.
+        // Fails if no deltas lead there, e.g. when updated reorders groups or items
+        static ContentGroups diff(const ContentGroups &original, const ContentGroups &updated);
 
-        // vanilla accessors
-        ContentWrapper getContentWrapper() { return ContentWrapper(content_groups); }
-        ContentGroups &getContentGroups() { return content_groups; }
+        // vanilla accessors; the mutable ones drop the cached hash state
+        ContentWrapper getContentWrapper()
+        {
+            hashCurrent = false;
+            return ContentWrapper(content_groups);
+        }
+        ContentGroups &getContentGroups()
+        {
+            hashCurrent = false;
+            return content_groups;
+        }
         const ContentGroups &getContentGroups() const { return content_groups; }
         const eosio::checksum256 &getHash() const { return hash; }
         const eosio::time_point &getCreated() const { return created_date; }
         const eosio::name &getCreator() const { return creator; }
         const eosio::name &getContract() const { return contract; }
+        std::vector<uint64_t> getGroupKeys() const { return group_keys.value_or(); }
+        std::uint8_t getHashVersion() const { return hash_version.value_or(1); }
+        // version 2 only: the hash of each content group, in order
+        std::vector<eosio::checksum256> getGroupHashes() const { return group_hashes.value_or(); }
+
+        // recomputes the hash of the stored content, and for version 2 the stored group hashes
+        bool hasValidHash() const;
+
+        // the content of this document; rows saved with group storage keep it in the group table
+        ContentGroups readContentGroups() const;
 
         // This has to be public in order to be reachable by the abi-generator macro
         // indexes for table
@@ -88,6 +208,23 @@ namespace hypha
         std::vector<Certificate> certificates;
         eosio::time_point created_date;
         eosio::name contract;
+        // set on documents saved with group storage, whose row keeps content_groups empty; version 2
+        // rows always carry it, empty when the content is inline, since the fields below follow it
+        eosio::binary_extension<std::vector<uint64_t>> group_keys;
+        // absent on version 1 rows
+        eosio::binary_extension<std::uint8_t> hash_version;
+        eosio::binary_extension<std::vector<eosio::checksum256>> group_hashes;
+
+        // not stored: hash and group_hashes match content_groups
+        bool hashCurrent = false;
+
+        // a row saved with group storage, as read from the table
+        bool hasStoredGroups() const
+        {
+            return group_keys.has_value() && !group_keys.value().empty() && content_groups.empty();
+        }
+
+        void setHashVersion(std::uint8_t hashVersion);
 
         // toString iterates through all content, all levels, concatenating all values
         // the resulting string is used for fingerprinting and hashing
@@ -95,7 +232,13 @@ namespace hypha
         static const std::string toString(const ContentGroups &contentGroups);
         static const std::string toString(const ContentGroup &contentGroup);
 
-        EOSLIB_SERIALIZE(Document, (id)(hash)(creator)(content_groups)(certificates)(created_date)(contract))
+        // exact size of toString() and a writer that fills a buffer of that size in one pass
+        static std::size_t canonicalSize(const ContentGroups &contentGroups);
+        static std::size_t canonicalSize(const ContentGroup &contentGroup);
+        static char *writeCanonical(const ContentGroups &contentGroups, char *out);
+        static char *writeCanonical(const ContentGroup &contentGroup, char *out);
+
+        EOSLIB_SERIALIZE(Document, (id)(hash)(creator)(content_groups)(certificates)(created_date)(contract)(group_keys)(hash_version)(group_hashes))
 
     public:
         // for unknown reason, primary_key() must be public
@@ -106,6 +249,75 @@ namespace hypha
                                    eosio::indexed_by<eosio::name("bycreator"), eosio::const_mem_fun<Document, uint64_t, &Document::by_creator>>,
                                    eosio::indexed_by<eosio::name("bycreated"), eosio::const_mem_fun<Document, uint64_t, &Document::by_created>>>
             document_table;
+
+        typedef eosio::singleton<eosio::name("dockeys"), DocumentKeyState> document_key_singleton;
+        typedef eosio::singleton<eosio::name("docaudit"), DocumentAuditState> document_audit_singleton;
+
+        // hash-derived keys collide only by chance; colliding documents take the next free key
+        static constexpr uint64_t MAX_KEY_PROBES = 16;
+
+        // the primary key a document prefers under key version 2
+        static uint64_t hashKey(const eosio::checksum256 &hash);
+
+        // the row holding hash, or d_t.end()
+        static document_table::const_iterator findByHash(const document_table &d_t, const eosio::checksum256 &hash);
+
+        // the primary key a new document with this hash is stored at
+        static uint64_t nextPrimaryKey(const document_table &d_t, const eosio::checksum256 &hash);
+
+        // stores an existing document row at the given primary key
+        static void emplaceAt(document_table &d_t, const Document &document, uint64_t key);
+
+        // erases the row and closes the gap in its probe sequence so later lookups still stop at the first empty key
+        static void eraseRow(document_table &d_t, document_table::const_iterator itr);
+
+        // the key state is read once per action and cached
+        static const DocumentKeyState &getKeyState(const eosio::name &contract);
+        static void setKeyState(const eosio::name &contract, const DocumentKeyState &state);
+
+        typedef eosio::singleton<eosio::name("headerstate"), DocumentHeaderState> header_state_singleton;
+
+        // the header state is read once per action and cached, like the key state
+        static const DocumentHeaderState &getHeaderState(const eosio::name &contract);
+        static void setHeaderState(const eosio::name &contract, const DocumentHeaderState &state);
+
+        DocumentHeader getHeader() const;
+
+        // reads only the header row once the header backfill is complete, the document row before that
+        static std::optional<DocumentHeader> getHeader(const eosio::name &contract, const eosio::checksum256 &hash);
+
+        // stores the header row for document when header storage is enabled
+        static void writeHeader(const Document &document);
+
+        typedef eosio::singleton<eosio::name("docstorage"), DocumentStorageState> storage_state_singleton;
+
+        static const DocumentStorageState &getStorageState(const eosio::name &contract);
+        static void setStorageState(const eosio::name &contract, const DocumentStorageState &state);
+
+        static eosio::checksum256 hashGroup(const ContentGroup &contentGroup);
+        static std::vector<eosio::checksum256> hashGroups(const ContentGroups &contentGroups);
+
+        // the version 2 document hash: sha256 of 0x02 and the Merkle root over groupHashes, where a
+        // node is sha256 of 0x01 and its two children and an odd node moves up unchanged; without
+        // groups it is sha256 of 0x02 alone
+        static eosio::checksum256 hashGroupTree(std::vector<eosio::checksum256> groupHashes);
+
+        typedef eosio::singleton<eosio::name("dochash"), DocumentHashState> hash_state_singleton;
+
+        static const DocumentHashState &getHashState(const eosio::name &contract);
+        static void setHashState(const eosio::name &contract, const DocumentHashState &state);
+
+        // finds or creates a group row for each group and returns their ids; a group matching an
+        // entry of releasedGroupKeys consumes that entry instead of gaining a reference
+        static std::vector<uint64_t> storeGroups(const eosio::name &contract, const ContentGroups &contentGroups,
+                                                 std::vector<uint64_t> releasedGroupKeys);
+
+        // drops one reference from each group in groupKeys that is not matched by keptGroupKeys
+        static void releaseGroups(const eosio::name &contract, const std::vector<uint64_t> &groupKeys,
+                                  std::vector<uint64_t> keptGroupKeys);
+
+    private:
+        static void eraseHeader(const eosio::name &contract, uint64_t key);
     };
 
 } // namespace hypha
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/time.hpp>
+
+namespace hypha
+{
+    // A document being erased in batches by DocumentGraph::eraseDocumentInBatches. The row
+    // exists while edges of the document remain; any caller can continue the job, and the
+    // document row is erased with the last batch. Removed edges leave their indexes, so each
+    // batch resumes at the start of the node's edge ranges and no position is stored.
+    struct PendingDeletion
+    {
+        std::uint64_t id;
+        eosio::checksum256 document_hash;
+        std::uint64_t edges_removed = 0;
+        std::uint64_t batches = 0;
+        eosio::time_point started;
+
+        uint64_t primary_key() const { return id; }
+        eosio::checksum256 by_hash() const { return document_hash; }
+
+        EOSLIB_SERIALIZE(PendingDeletion, (id)(document_hash)(edges_removed)(batches)(started))
+
+        typedef eosio::multi_index<eosio::name("deletions"), PendingDeletion,
+                                   eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<PendingDeletion, eosio::checksum256, &PendingDeletion::by_hash>>>
+            deletion_table;
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstring>
+#include <map>
+#include <optional>
 
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
@@ -11,7 +13,11 @@
 
 #include <document_graph/content.hpp>
 #include <document_graph/document.hpp>
+#include <document_graph/document_deletion.hpp>
 #include <document_graph/edge.hpp>
+#include <document_graph/edge_range.hpp>
+#include <document_graph/graph_operation.hpp>
+#include <document_graph/graph_traversal.hpp>
 
 namespace hypha
 {
@@ -21,6 +27,20 @@ namespace hypha
         DocumentGraph(const eosio::name &contract) : m_contract(contract) {}
         ~DocumentGraph() {}
 
+        struct CacheStats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+        };
+
+        // Documents are content addressed, so a loaded document stays valid until it is erased.
+        // getDocument keeps them for the lifetime of this DocumentGraph; the returned reference is
+        // invalidated when that document is erased or updated through it. Erases that go around
+        // this instance, such as another DocumentGraph or Document::eraseRow, are not seen, so an
+        // instance should not outlive the action that created it.
+        const Document &getDocument(const eosio::checksum256 &documentHash);
+        const CacheStats &getCacheStats() const { return m_cacheStats; }
+
         void removeEdges(const eosio::checksum256 &node);
 
         std::vector<Edge> getEdges(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode);
@@ -32,20 +52,119 @@ namespace hypha
         std::vector<Edge> getEdgesTo(const eosio::checksum256 &toNode, const eosio::name &edgeName);
         std::vector<Edge> getEdgesToOrFail(const eosio::checksum256 &toNode, const eosio::name &edgeName);
 
+        // lazy versions of getEdges, getEdgesFrom and getEdgesTo; see EdgeRange
+        EdgeRange edgesBetween(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode) const;
+        EdgeRange edgesFrom(const eosio::checksum256 &fromNode, const eosio::name &edgeName) const;
+        EdgeRange edgesTo(const eosio::checksum256 &toNode, const eosio::name &edgeName) const;
+
         Edge createEdge(eosio::name &creator, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode, const eosio::name &edgeName);
 
         Document updateDocument(const eosio::name &updater,
                                 const eosio::checksum256 &doc_hash,
                                 ContentGroups content_groups);
 
+        // the same with only the changes sent: deltas are merged into the current content,
+        // see Document::merge
+        Document mergeDocument(const eosio::name &updater,
+                               const eosio::checksum256 &doc_hash,
+                               const Document &deltas);
+
         bool hasEdges(const eosio::checksum256 &node);
         
-        void replaceNode(const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode);
+        // re-points the edges of oldNode to newNode; returns the number of edge rows rewritten
+        uint64_t replaceNode(const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode);
         void eraseDocument(const eosio::checksum256 &document_hash);
         void eraseDocument(const eosio::checksum256 &document_hash, const bool includeEdges);
 
+        // re-keys existing edges to the v2 composite keys in bounded batches
+        bool migrateEdgeKeys(const uint64_t batchSize);
+
+        // moves existing documents to hash-derived primary keys in bounded batches
+        bool migrateDocumentKeys(const uint64_t batchSize);
+
+        // enables header rows and backfills them for existing documents in bounded batches
+        bool migrateDocumentHeaders(const uint64_t batchSize);
+
+        // recomputes the hashes of up to batchSize stored documents, continuing the current audit pass
+        DocumentAuditState auditDocuments(const uint64_t batchSize);
+
+        // switches edges to stable node ids and moves existing edges over in bounded batches
+        bool migrateNodeIds(const uint64_t batchSize);
+
+        // removes up to batchSize edges of the document, starting or continuing its pending
+        // deletion; returns true once the edges and the document are gone
+        bool eraseDocumentInBatches(const eosio::checksum256 &documentHash, const uint64_t batchSize);
+        std::optional<PendingDeletion> getPendingDeletion(const eosio::checksum256 &documentHash);
+
+        // applies a list of create/newedge/removeedge/erase operations over shared table handles
+        // and returns the hashes of the documents it created
+        std::vector<eosio::checksum256> applyBatch(const std::vector<GraphOperation> &operations);
+
+        // number of edges named edgeName leaving (Out) or entering (In) node, read from its
+        // counter row; fails until rebuildDegrees has completed
+        uint64_t degree(const eosio::checksum256 &node, const eosio::name &edgeName, const EdgeDirection direction) const;
+
+        // turns on degree counters and counts existing edges in bounded batches
+        bool rebuildDegrees(const uint64_t batchSize);
+
+        // up to limit edges named edgeName from (Out) or to (In) node, newest or oldest first,
+        // continuing after an earlier page; fails until buildEdgeTimes has completed
+        EdgePage edgesByTime(const eosio::checksum256 &node, const eosio::name &edgeName,
+                             const EdgeDirection direction, const EdgeOrder order, const uint32_t limit,
+                             const std::optional<EdgeTimeCursor> &after = std::nullopt) const;
+
+        // builds the edge time index over existing node id edges in bounded batches
+        bool buildEdgeTimes(const uint64_t batchSize);
+
+        // whether a path of edgeName edges leads from ancestor to descendant, answered by one
+        // lookup in the ancestry closure; fails until buildClosure has completed for edgeName
+        bool isAncestor(const eosio::checksum256 &ancestor, const eosio::checksum256 &descendant, const eosio::name &edgeName) const;
+
+        // keeps an ancestry closure for edgeName and adds existing edges to it in bounded batches;
+        // afterwards an edgeName edge changing more than maxUpdates ancestry rows, or closing a
+        // cycle, is refused
+        bool buildClosure(const eosio::name &edgeName, const uint64_t maxUpdates, const uint64_t batchSize);
+
+        // walks the graph from start as spec allows, calling visitor for each node reached; the
+        // token is done unless the budget ran out, and resumeTraversal continues it
+        TraversalToken traverse(const eosio::checksum256 &start, const TraversalSpec &spec, const TraversalVisitor &visitor) const;
+        TraversalToken resumeTraversal(TraversalToken token, const TraversalSpec &spec, const TraversalVisitor &visitor) const;
+
+        // a shortest path from fromNode to toNode over edges named in edgeNames, of at most
+        // maxHops edges, searched from both ends; see GraphTraversal::findPath
+        std::optional<std::vector<Edge>> findPath(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                                                  const std::vector<eosio::name> &edgeNames, const uint32_t maxHops) const;
+        bool isReachable(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                         const std::vector<eosio::name> &edgeNames, const uint32_t maxHops) const;
+
     private:
+        // removes up to limit edges of node and returns how many were removed
+        uint64_t removeEdges(const eosio::checksum256 &node, const uint64_t limit);
+        uint64_t removeEdges(Edge::edge_table &e_t, NodeEdge::node_edge_table &ne_t, DocumentNode::node_table &n_t,
+                             const eosio::checksum256 &node, const uint64_t limit);
+
+        // the node id mode parts of removeEdges and replaceNode
+        uint64_t removeNodeEdges(NodeEdge::node_edge_table &ne_t, DocumentNode::node_table &n_t,
+                                 const eosio::checksum256 &node, const uint64_t limit);
+        uint64_t replaceNodeId(const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode);
+        // moves edges of the edges table into nodeedges while the node id migration runs
+        uint64_t moveNodeEdges(const eosio::checksum256 &node);
+        void moveToNodeEdge(NodeEdge::node_edge_table &ne_t, const Edge &edge);
+
+        // state shared by the operations of applyBatch
+        struct Batch;
+        void batchWriteEdge(Batch &batch, const eosio::name &creator, const eosio::checksum256 &fromNode,
+                            const eosio::checksum256 &toNode, const eosio::name &edgeName);
+        void batchRemoveEdge(Batch &batch, const eosio::checksum256 &fromNode,
+                             const eosio::checksum256 &toNode, const eosio::name &edgeName);
+
+        // keptGroupKeys are group references handed over to a new revision, see Document::emplaceRevision
+        void eraseDocument(const eosio::checksum256 &document_hash, const bool includeEdges,
+                           const std::vector<uint64_t> &keptGroupKeys);
+
         eosio::name m_contract;
+        std::map<eosio::checksum256, Document> m_documentCache;
+        CacheStats m_cacheStats;
     };
 }; // namespace hypha
 
@@ -69,4 +188,66 @@ using edge_table = eosio::multi_index<eosio::name("edges"), contract_edge,\
             eosio::indexed_by<eosio::name("byfromto"), eosio::const_mem_fun<root_edge, uint64_t, &root_edge::by_from_node_to_node_index>>,\
             eosio::indexed_by<eosio::name("bytoname"), eosio::const_mem_fun<root_edge, uint64_t, &root_edge::by_to_node_edge_name_index>>,\
             eosio::indexed_by<eosio::name("bycreated"), eosio::const_mem_fun<root_edge, uint64_t, &root_edge::by_created>>,\
-            eosio::indexed_by<eosio::name("bycreator"), eosio::const_mem_fun<root_edge, uint64_t, &root_edge::by_creator>>>;
\ No newline at end of file
+            eosio::indexed_by<eosio::name("bycreator"), eosio::const_mem_fun<root_edge, uint64_t, &root_edge::by_creator>>>;\
+TABLE contract##_edgekeys : public hypha::EdgeKeyState {};\
+using edge_key_singleton = eosio::singleton<eosio::name("edgekeys"), contract##_edgekeys>;\
+TABLE contract##_dockeys : public hypha::DocumentKeyState {};\
+using document_key_singleton = eosio::singleton<eosio::name("dockeys"), contract##_dockeys>;\
+TABLE contract##_docaudit : public hypha::DocumentAuditState {};\
+using document_audit_singleton = eosio::singleton<eosio::name("docaudit"), contract##_docaudit>;\
+using root_header = hypha::DocumentHeader;\
+TABLE contract##_docheader : public root_header {};\
+using document_header_table = eosio::multi_index<eosio::name("docheaders"), contract##_docheader,\
+            eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<root_header, eosio::checksum256, &root_header::by_hash>>,\
+            eosio::indexed_by<eosio::name("bycreator"), eosio::const_mem_fun<root_header, uint64_t, &root_header::by_creator>>,\
+            eosio::indexed_by<eosio::name("bycreated"), eosio::const_mem_fun<root_header, uint64_t, &root_header::by_created>>,\
+            eosio::indexed_by<eosio::name("bytype"), eosio::const_mem_fun<root_header, uint64_t, &root_header::by_type>>>;\
+TABLE contract##_headerstate : public hypha::DocumentHeaderState {};\
+using header_state_singleton = eosio::singleton<eosio::name("headerstate"), contract##_headerstate>;\
+using root_group = hypha::DocumentGroup;\
+TABLE contract##_docgroup : public root_group {};\
+using document_group_table = eosio::multi_index<eosio::name("docgroups"), contract##_docgroup,\
+            eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<root_group, eosio::checksum256, &root_group::by_hash>>>;\
+TABLE contract##_docstorage : public hypha::DocumentStorageState {};\
+using storage_state_singleton = eosio::singleton<eosio::name("docstorage"), contract##_docstorage>;\
+TABLE contract##_dochash : public hypha::DocumentHashState {};\
+using hash_state_singleton = eosio::singleton<eosio::name("dochash"), contract##_dochash>;\
+using root_node = hypha::DocumentNode;\
+TABLE contract##_docnode : public root_node {};\
+using document_node_table = eosio::multi_index<eosio::name("docnodes"), contract##_docnode,\
+            eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<root_node, eosio::checksum256, &root_node::by_hash>>>;\
+using root_node_edge = hypha::NodeEdge;\
+TABLE contract##_nodeedge : public root_node_edge {};\
+using node_edge_table = eosio::multi_index<eosio::name("nodeedges"), contract##_nodeedge,\
+            eosio::indexed_by<eosio::name("byfromname"), eosio::const_mem_fun<root_node_edge, uint128_t, &root_node_edge::by_from_node_edge_name>>,\
+            eosio::indexed_by<eosio::name("bytoname"), eosio::const_mem_fun<root_node_edge, uint128_t, &root_node_edge::by_to_node_edge_name>>,\
+            eosio::indexed_by<eosio::name("byfromto"), eosio::const_mem_fun<root_node_edge, uint128_t, &root_node_edge::by_from_node_to_node>>,\
+            eosio::indexed_by<eosio::name("edgename"), eosio::const_mem_fun<root_node_edge, uint64_t, &root_node_edge::by_edge_name>>>;\
+TABLE contract##_nodeids : public hypha::NodeIdState {};\
+using node_id_singleton = eosio::singleton<eosio::name("nodeids"), contract##_nodeids>;\
+using root_deletion = hypha::PendingDeletion;\
+TABLE contract##_deletion : public root_deletion {};\
+using pending_deletion_table = eosio::multi_index<eosio::name("deletions"), contract##_deletion,\
+            eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<root_deletion, eosio::checksum256, &root_deletion::by_hash>>>;\
+using root_counter = hypha::EdgeCounter;\
+TABLE contract##_edgecount : public root_counter {};\
+using edge_counter_table = eosio::multi_index<eosio::name("edgecounts"), contract##_edgecount,\
+            eosio::indexed_by<eosio::name("bynodename"), eosio::const_mem_fun<root_counter, uint64_t, &root_counter::by_node_name>>,\
+            eosio::indexed_by<eosio::name("bynode"), eosio::const_mem_fun<root_counter, eosio::checksum256, &root_counter::by_node>>>;\
+TABLE contract##_degreestate : public hypha::DegreeState {};\
+using degree_singleton = eosio::singleton<eosio::name("degreestate"), contract##_degreestate>;\
+using root_time = hypha::EdgeTime;\
+TABLE contract##_edgetime : public root_time {};\
+using edge_time_table = eosio::multi_index<eosio::name("edgetimes"), contract##_edgetime,\
+            eosio::indexed_by<eosio::name("byfromtime"), eosio::const_mem_fun<root_time, eosio::checksum256, &root_time::by_from_time>>,\
+            eosio::indexed_by<eosio::name("bytotime"), eosio::const_mem_fun<root_time, eosio::checksum256, &root_time::by_to_time>>>;\
+TABLE contract##_timeindex : public hypha::EdgeTimeState {};\
+using time_index_singleton = eosio::singleton<eosio::name("timeindex"), contract##_timeindex>;\
+using root_ancestry = hypha::Ancestry;\
+TABLE contract##_ancestry : public root_ancestry {};\
+using ancestry_table = eosio::multi_index<eosio::name("ancestry"), contract##_ancestry,\
+            eosio::indexed_by<eosio::name("bypair"), eosio::const_mem_fun<root_ancestry, eosio::checksum256, &root_ancestry::by_pair>>,\
+            eosio::indexed_by<eosio::name("byancestor"), eosio::const_mem_fun<root_ancestry, eosio::checksum256, &root_ancestry::by_ancestor>>,\
+            eosio::indexed_by<eosio::name("bydesc"), eosio::const_mem_fun<root_ancestry, eosio::checksum256, &root_ancestry::by_descendant>>>;\
+TABLE contract##_closures : public hypha::ClosureState {};\
+using closure_singleton = eosio::singleton<eosio::name("closures"), contract##_closures>;
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+
+#include <document_graph/content_wrapper.hpp>
+
+namespace hypha
+{
+    // One content group of a document saved with group storage. A row is shared by every stored
+    // document that contains this exact group, counted in references, and erased with the last.
+    // Group ids never change while referenced, so documents refer to their groups by id.
+    struct DocumentGroup
+    {
+        std::uint64_t id;
+        // sha256 of the group's canonical encoding, used to find an identical group on write
+        eosio::checksum256 hash;
+        std::uint32_t references = 0;
+        ContentGroup content_group;
+
+        uint64_t primary_key() const { return id; }
+        eosio::checksum256 by_hash() const { return hash; }
+
+        EOSLIB_SERIALIZE(DocumentGroup, (id)(hash)(references)(content_group))
+
+        typedef eosio::multi_index<eosio::name("docgroups"), DocumentGroup,
+                                   eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<DocumentGroup, eosio::checksum256, &DocumentGroup::by_hash>>>
+            group_table;
+    };
+
+    // Selects how new documents are saved. Reads handle both layouts, so this can change at any time.
+    struct DocumentStorageState
+    {
+        bool group_storage = false;
+
+        EOSLIB_SERIALIZE(DocumentStorageState, (group_storage))
+    };
+
+} // namespace hypha
\ No newline at end of file
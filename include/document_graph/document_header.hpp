@@ -0,0 +1,54 @@
+#pragma once
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/time.hpp>
+
+namespace hypha
+{
+    // Compact row stored next to each document once header storage is enabled. It shares the
+    // document's primary key, so lookups by hash, creator, creation time or type read this
+    // row instead of the row carrying the content groups.
+    struct DocumentHeader
+    {
+        std::uint64_t id;
+        eosio::checksum256 hash;
+        eosio::name creator;
+        // value of the first "type" item holding a name, if any
+        eosio::name type;
+        // serialized size of the content groups
+        std::uint32_t body_size = 0;
+        eosio::time_point created_date;
+
+        uint64_t primary_key() const { return id; }
+        uint64_t by_created() const { return created_date.sec_since_epoch(); }
+        uint64_t by_creator() const { return creator.value; }
+        uint64_t by_type() const { return type.value; }
+        eosio::checksum256 by_hash() const { return hash; }
+
+        EOSLIB_SERIALIZE(DocumentHeader, (id)(hash)(creator)(type)(body_size)(created_date))
+
+        typedef eosio::multi_index<eosio::name("docheaders"), DocumentHeader,
+                                   eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<DocumentHeader, eosio::checksum256, &DocumentHeader::by_hash>>,
+                                   eosio::indexed_by<eosio::name("bycreator"), eosio::const_mem_fun<DocumentHeader, uint64_t, &DocumentHeader::by_creator>>,
+                                   eosio::indexed_by<eosio::name("bycreated"), eosio::const_mem_fun<DocumentHeader, uint64_t, &DocumentHeader::by_created>>,
+                                   eosio::indexed_by<eosio::name("bytype"), eosio::const_mem_fun<DocumentHeader, uint64_t, &DocumentHeader::by_type>>>
+            header_table;
+    };
+
+    // Header storage is off until the contract starts the header migration. From then on every
+    // document write maintains its header, and the migration backfills headers for older rows.
+    // Reads switch to the headers once the backfill is complete.
+    struct DocumentHeaderState
+    {
+        bool migrating = false;
+        bool complete = false;
+        std::uint64_t cursor = 0;
+
+        bool enabled() const { return migrating || complete; }
+
+        EOSLIB_SERIALIZE(DocumentHeaderState, (migrating)(complete)(cursor))
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <document_graph/content.hpp>
+#include <document_graph/content_wrapper.hpp>
+
+namespace hypha
+{
+    // One item of a document schema: the labels of its group and item, and the member it is
+    // decoded into. The member holds one of the Content value types; wrapped in std::optional
+    // the item may be absent.
+    template <typename T, typename M>
+    struct SchemaField
+    {
+        std::string_view group;
+        std::string_view label;
+        M T::*member;
+    };
+
+    template <typename T, typename M>
+    constexpr SchemaField<T, M> schemaField(std::string_view group, std::string_view label, M T::*member)
+    {
+        return {group, label, member};
+    }
+
+    namespace schema_detail
+    {
+        template <typename M>
+        struct Member
+        {
+            using value_type = M;
+            static constexpr bool required = true;
+        };
+
+        template <typename M>
+        struct Member<std::optional<M>>
+        {
+            using value_type = M;
+            static constexpr bool required = false;
+        };
+
+        template <typename V, typename... A>
+        constexpr bool holdsType(const std::variant<A...> *) { return (std::is_same_v<V, A> || ...); }
+
+        // the group labelled group, appended if contentGroups has none yet
+        ContentGroup &groupFor(ContentGroups &contentGroups, std::string_view group);
+    } // namespace schema_detail
+
+    // Typed access to documents with a known layout. T lists its items in a static constexpr
+    // schema() function, and decode fills a T in one pass over the groups, checking types and
+    // required items once; after that each item is a member read:
+    //
+    //   struct Payout
+    //   {
+    //       eosio::name recipient;
+    //       eosio::asset amount;
+    //       std::optional<eosio::time_point> due;
+    //
+    //       static constexpr auto schema()
+    //       {
+    //           return std::make_tuple(schemaField("details", "recipient", &Payout::recipient),
+    //                                  schemaField("details", "amount", &Payout::amount),
+    //                                  schemaField("details", "due", &Payout::due));
+    //       }
+    //   };
+    //
+    //   Payout payout = DocumentSchema<Payout>::decode(document.getContentGroups());
+    //
+    // As with ContentWrapper, an item is read from the first group with its group label, and
+    // the first item with its label there. Groups and items outside the schema are ignored.
+    template <typename T>
+    class DocumentSchema
+    {
+        using Fields = decltype(T::schema());
+        static constexpr size_t FIELD_COUNT = std::tuple_size_v<Fields>;
+
+    public:
+        static T decode(const ContentGroups &contentGroups)
+        {
+            return decode(contentGroups, std::make_index_sequence<FIELD_COUNT>{});
+        }
+
+        // the groups in the order the schema first names them, each item in schema order;
+        // optional members that are empty are left out
+        static ContentGroups encode(const T &value)
+        {
+            return encode(value, std::make_index_sequence<FIELD_COUNT>{});
+        }
+
+    private:
+        template <size_t... I>
+        static T decode(const ContentGroups &contentGroups, std::index_sequence<I...>)
+        {
+            constexpr Fields fields = T::schema();
+            const std::array<std::string_view, FIELD_COUNT> groups{std::get<I>(fields).group...};
+            const std::array<std::string_view, FIELD_COUNT> labels{std::get<I>(fields).label...};
+
+            std::array<const Content *, FIELD_COUNT> found{};
+            std::array<bool, FIELD_COUNT> groupFound{};
+            for (const ContentGroup &contentGroup : contentGroups)
+            {
+                // the fields this group holds, unless an earlier group had the same label
+                const string_view groupLabel = ContentWrapper::getGroupLabel(contentGroup);
+                std::array<bool, FIELD_COUNT> inGroup{};
+                bool any = false;
+                for (size_t i = 0; i < FIELD_COUNT; ++i)
+                {
+                    if (!groupFound[i] && groups[i] == groupLabel)
+                    {
+                        groupFound[i] = inGroup[i] = any = true;
+                    }
+                }
+
+                for (size_t j = 0; any && j < contentGroup.size(); ++j)
+                {
+                    for (size_t i = 0; i < FIELD_COUNT; ++i)
+                    {
+                        if (inGroup[i] && !found[i] && contentGroup[j].label == labels[i])
+                        {
+                            found[i] = &contentGroup[j];
+                        }
+                    }
+                }
+            }
+
+            T value{};
+            const std::array<bool, FIELD_COUNT> valid{read(value, std::get<I>(fields), found[I])...};
+            if (std::find(valid.begin(), valid.end(), false) != valid.end())
+            {
+                const std::array<bool, FIELD_COUNT> present{(found[I] != nullptr)...};
+                ContentWrapper::failItems("document schema", groups.data(), labels.data(), present.data(), valid.data(), FIELD_COUNT);
+            }
+            return value;
+        }
+
+        template <typename M>
+        static bool read(T &value, const SchemaField<T, M> &field, const Content *content)
+        {
+            using V = typename schema_detail::Member<M>::value_type;
+            static_assert(schema_detail::holdsType<V>(static_cast<Content::FlexValue *>(nullptr)),
+                          "schema members must hold a Content value type");
+
+            if (!content)
+            {
+                return !schema_detail::Member<M>::required;
+            }
+            if (!std::holds_alternative<V>(content->value))
+            {
+                return false;
+            }
+            value.*field.member = std::get<V>(content->value);
+            return true;
+        }
+
+        template <size_t... I>
+        static ContentGroups encode(const T &value, std::index_sequence<I...>)
+        {
+            constexpr Fields fields = T::schema();
+            ContentGroups contentGroups;
+            (write(contentGroups, value, std::get<I>(fields)), ...);
+            return contentGroups;
+        }
+
+        template <typename M>
+        static void write(ContentGroups &contentGroups, const T &value, const SchemaField<T, M> &field)
+        {
+            const M &member = value.*field.member;
+            if constexpr (schema_detail::Member<M>::required)
+            {
+                schema_detail::groupFor(contentGroups, field.group).push_back(Content{std::string(field.label), member});
+            }
+            else if (member)
+            {
+                schema_detail::groupFor(contentGroups, field.group).push_back(Content{std::string(field.label), *member});
+            }
+        }
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <eosio/crypto.hpp>
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+
+#include <document_graph/content.hpp>
+#include <document_graph/content_wrapper.hpp>
+#include <document_graph/document.hpp>
+
+namespace hypha
+{
+    // Read-only view over the serialized row of a stored document. Only id, hash and creator
+    // are decoded up front; the rest of the row stays as bytes. The first access that needs
+    // the body walks it once, recording where each content group starts, without building
+    // any Content; for documents saved with group storage it reads their group rows instead.
+    // Accessors then decode only the group or item that was asked for.
+    //
+    // The stored hash is trusted, as with LoadMode::Trusted.
+    class DocumentView
+    {
+    public:
+        // reads the row holding hash; fails if there is none
+        DocumentView(const eosio::name &contract, const eosio::checksum256 &hash);
+
+        // the group spans point into the row buffers, which a move carries along but a copy
+        // would not
+        DocumentView(const DocumentView &) = delete;
+        DocumentView &operator=(const DocumentView &) = delete;
+        DocumentView(DocumentView &&) = default;
+        DocumentView &operator=(DocumentView &&) = default;
+
+        static bool exists(const eosio::name &contract, const eosio::checksum256 &hash);
+
+        uint64_t getId() const { return m_id; }
+        const eosio::checksum256 &getHash() const { return m_hash; }
+        const eosio::name &getCreator() const { return m_creator; }
+        eosio::time_point getCreated();
+        eosio::name getContract();
+
+        // ContentWrapper-style accessors that return decoded copies
+        std::size_t getGroupCount();
+        std::optional<ContentGroup> getGroup(const std::string &label);
+        ContentGroup getGroupOrFail(const std::string &label, const std::string &error);
+        ContentGroup getGroupOrFail(const std::string &groupLabel);
+
+        std::optional<Content> get(const std::string &groupLabel, const std::string &contentLabel);
+        Content getOrFail(const std::string &groupLabel, const std::string &contentLabel, const std::string &error);
+        Content getOrFail(const std::string &groupLabel, const std::string &contentLabel);
+
+        // loads the whole document
+        Document toDocument();
+
+    private:
+        // one serialized ContentGroup, in the document row or in its group row
+        struct GroupSpan
+        {
+            std::string_view label;
+            std::string_view bytes;
+        };
+
+        static std::optional<std::vector<char>> readRow(const eosio::name &contract, const eosio::checksum256 &hash);
+
+        void index();
+        const GroupSpan *findGroup(const std::string &label);
+
+        std::vector<char> m_row;
+        uint64_t m_id;
+        eosio::checksum256 m_hash;
+        eosio::name m_creator;
+
+        bool m_indexed = false;
+        std::vector<GroupSpan> m_groups;
+        // rows of documents saved with group storage; m_groups points into them
+        std::vector<std::vector<char>> m_groupRows;
+        // offset of created_date, which is followed by contract
+        uint32_t m_created = 0;
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -4,9 +4,38 @@
 #include <eosio/time.hpp>
 #include <eosio/multi_index.hpp>
 #include <eosio/crypto.hpp>
+#include <eosio/singleton.hpp>
+
+#include <document_graph/edge_closure.hpp>
+#include <document_graph/edge_counter.hpp>
+#include <document_graph/edge_time.hpp>
+#include <document_graph/node_edge.hpp>
 
 namespace hypha
 {
+    // Tracks which composite key scheme the edges table uses. Version 1 is the legacy
+    // hex-string concatHash, version 2 is compositeKey over the raw digests. The row is
+    // absent until the first migration batch runs; while migrating, writes use version 2
+    // and reads also probe version 1 keys.
+    struct EdgeKeyState
+    {
+        std::uint8_t key_version = 1;
+        bool migrating = false;
+        std::uint64_t cursor = 0;
+
+        EOSLIB_SERIALIZE(EdgeKeyState, (key_version)(migrating)(cursor))
+    };
+
+    // key versions a read has to probe, the written scheme first
+    struct EdgeKeyVersions
+    {
+        std::uint8_t versions[2];
+        std::uint8_t count;
+
+        const std::uint8_t *begin() const { return versions; }
+        const std::uint8_t *end() const { return versions + count; }
+    };
+
     struct Edge
     {
         Edge();
@@ -36,6 +65,9 @@ namespace hypha
                           const eosio::checksum256 &_to_node,
                           const eosio::name &_edge_name);
 
+        // fails unless edgeName is a valid edge name
+        static void checkName(const eosio::name &edgeName);
+
         static Edge get(const eosio::name &contract,
                         const eosio::checksum256 &from_node,
                         const eosio::checksum256 &to_node,
@@ -58,6 +90,39 @@ namespace hypha
                            const eosio::checksum256 &_to_node,
                            const eosio::name &_edge_name);
 
+        // composite keys under a given key scheme version
+        static uint64_t idKey(std::uint8_t keyVersion, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode, const eosio::name &edgeName);
+        static uint64_t fromNameKey(std::uint8_t keyVersion, const eosio::checksum256 &fromNode, const eosio::name &edgeName);
+        static uint64_t fromToKey(std::uint8_t keyVersion, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode);
+        static uint64_t toNameKey(std::uint8_t keyVersion, const eosio::checksum256 &toNode, const eosio::name &edgeName);
+
+        // the key state is read once per action and cached
+        static const EdgeKeyState &getKeyState(const eosio::name &contract);
+        static void setKeyState(const eosio::name &contract, const EdgeKeyState &state);
+        static std::uint8_t writeKeyVersion(const eosio::name &contract);
+        static EdgeKeyVersions readKeyVersions(const eosio::name &contract);
+
+        // node id mode, cached like the key state
+        static const NodeIdState &getNodeIdState(const eosio::name &contract);
+        static void setNodeIdState(const eosio::name &contract, const NodeIdState &state);
+
+        // degree counters, cached like the key state
+        static const DegreeState &getDegreeState(const eosio::name &contract);
+        static void setDegreeState(const eosio::name &contract, const DegreeState &state);
+
+        // edge time index, cached like the key state
+        static const EdgeTimeState &getTimeIndexState(const eosio::name &contract);
+        static void setTimeIndexState(const eosio::name &contract, const EdgeTimeState &state);
+
+        // ancestry closures, cached like the key state
+        static const ClosureState &getClosureState(const eosio::name &contract);
+        static void setClosureState(const eosio::name &contract, const ClosureState &state);
+
+        // the edge a nodeedges row stores, with its node ids resolved to document hashes
+        static Edge fromNodeEdge(const eosio::name &contract, const NodeEdge &nodeEdge);
+        static Edge fromNodeEdge(const eosio::name &contract, const NodeEdge &nodeEdge,
+                                 const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode);
+
         uint64_t id; // hash of from_node, to_node, and edge_name
 
         // these three additional indexes allow isolating/querying edges more precisely (less iteration)
@@ -95,6 +160,19 @@ namespace hypha
                                    eosio::indexed_by<eosio::name("bycreated"), eosio::const_mem_fun<Edge, uint64_t, &Edge::by_created>>,
                                    eosio::indexed_by<eosio::name("bycreator"), eosio::const_mem_fun<Edge, uint64_t, &Edge::by_creator>>>
             edge_table;
+
+        typedef eosio::singleton<eosio::name("edgekeys"), EdgeKeyState> edge_key_singleton;
+        typedef eosio::singleton<eosio::name("nodeids"), NodeIdState> node_id_singleton;
+        typedef eosio::singleton<eosio::name("degreestate"), DegreeState> degree_singleton;
+        typedef eosio::singleton<eosio::name("timeindex"), EdgeTimeState> time_index_singleton;
+        typedef eosio::singleton<eosio::name("closures"), ClosureState> closure_singleton;
+
+        // the edges table row for this edge under any key version still present, or e_t.end()
+        static edge_table::const_iterator find(const edge_table &e_t,
+                                               const eosio::name &contract,
+                                               const eosio::checksum256 &fromNode,
+                                               const eosio::checksum256 &toNode,
+                                               const eosio::name &edgeName);
     };
 
 } // namespace hypha
\ No newline at end of file
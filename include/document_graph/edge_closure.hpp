@@ -0,0 +1,98 @@
+#pragma once
+
+#include <vector>
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+
+namespace hypha
+{
+    // An edge name with an ancestry closure. The closure is built over existing edges in
+    // primary key order, the nodeedges table first; rows the build has passed are kept by edge
+    // writes, and ancestry can be read once it is done.
+    struct ClosureConfig
+    {
+        eosio::name edge_name;
+        // most ancestry rows one new edge may change; edges over the bound are refused
+        std::uint64_t max_updates = 0;
+        bool building = true;
+        // the table the build is walking, see EdgeIndexes
+        std::uint8_t source = 0;
+        // next primary key the build includes in source
+        std::uint64_t cursor = 0;
+
+        // whether the closure includes the row with this id in rowSource
+        bool includes(std::uint8_t rowSource, uint64_t id) const
+        {
+            return !building || rowSource < source || (rowSource == source && id < cursor);
+        }
+
+        EOSLIB_SERIALIZE(ClosureConfig, (edge_name)(max_updates)(building)(source)(cursor))
+    };
+
+    // The edge names with a closure. There are few, so they share one row that is read once per action.
+    struct ClosureState
+    {
+        std::vector<ClosureConfig> configs;
+
+        const ClosureConfig *find(const eosio::name &edgeName) const;
+        ClosureConfig *find(const eosio::name &edgeName);
+
+        EOSLIB_SERIALIZE(ClosureState, (configs))
+    };
+
+    // A pair of documents joined by a path of edges with one name, and how many distinct
+    // paths join them. Counting paths lets an edge removal subtract exactly what its write
+    // added, which is why the edges of a closure name must stay acyclic.
+    struct Ancestry
+    {
+        std::uint64_t id;
+        eosio::checksum256 ancestor;
+        eosio::checksum256 descendant;
+        eosio::name edge_name;
+        std::uint64_t paths = 0;
+        // pairKey of the row, stored so the index does not hash on every access
+        eosio::checksum256 pair_key;
+
+        uint64_t primary_key() const { return id; }
+        eosio::checksum256 by_pair() const { return pair_key; }
+        eosio::checksum256 by_ancestor() const { return ancestor; }
+        eosio::checksum256 by_descendant() const { return descendant; }
+
+        static eosio::checksum256 pairKey(const eosio::checksum256 &ancestor, const eosio::checksum256 &descendant, const eosio::name &edgeName);
+
+        EOSLIB_SERIALIZE(Ancestry, (id)(ancestor)(descendant)(edge_name)(paths)(pair_key))
+
+        typedef eosio::multi_index<eosio::name("ancestry"), Ancestry,
+                                   eosio::indexed_by<eosio::name("bypair"), eosio::const_mem_fun<Ancestry, eosio::checksum256, &Ancestry::by_pair>>,
+                                   eosio::indexed_by<eosio::name("byancestor"), eosio::const_mem_fun<Ancestry, eosio::checksum256, &Ancestry::by_ancestor>>,
+                                   eosio::indexed_by<eosio::name("bydesc"), eosio::const_mem_fun<Ancestry, eosio::checksum256, &Ancestry::by_descendant>>>
+            ancestry_table;
+    };
+
+    class EdgeClosure
+    {
+    public:
+        // whether a path of edgeName edges leads from ancestor to descendant; fails unless
+        // edgeName has a built closure
+        static bool isAncestor(const eosio::name &contract, const eosio::checksum256 &ancestor,
+                               const eosio::checksum256 &descendant, const eosio::name &edgeName);
+
+        // whether a closure includes the edge row with this id in source
+        static bool includes(const eosio::name &contract, const eosio::name &edgeName, std::uint8_t source, uint64_t id);
+
+        // adds (delta 1) or removes (delta -1) the paths through the edge, if its closure includes the row
+        static void adjust(const eosio::name &contract, std::uint8_t source, uint64_t id,
+                           const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                           const eosio::name &edgeName, int64_t delta);
+
+        // adds or removes the paths through the edge, ignoring whether any row is included
+        static void apply(const eosio::name &contract, const ClosureConfig &config,
+                          const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode, int64_t delta);
+
+        // rewrites the ancestry of oldNode to newNode, which must have none for the same names
+        static void renameNode(const eosio::name &contract, const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode);
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+
+namespace hypha
+{
+    enum class EdgeDirection : std::uint8_t
+    {
+        // edges from the node
+        Out = 0,
+        // edges to the node
+        In = 1
+    };
+
+    // Degree counters are off until the first rebuild batch. The rebuild walks the nodeedges
+    // table and then the edges table in primary key order; a row is counted once the walk has
+    // passed it, and edge writes meanwhile keep the counters of counted rows current. Degrees
+    // can be read once the rebuild is complete.
+    struct DegreeState
+    {
+        bool enabled = false;
+        bool rebuilding = false;
+        // the table the rebuild is walking, see EdgeIndexes
+        std::uint8_t source = 0;
+        // next primary key the rebuild counts in source
+        std::uint64_t cursor = 0;
+
+        bool ready() const { return enabled && !rebuilding; }
+
+        // whether the counters include the row with this id in rowSource
+        bool counts(std::uint8_t rowSource, uint64_t id) const
+        {
+            return enabled && (!rebuilding || rowSource < source || (rowSource == source && id < cursor));
+        }
+
+        EOSLIB_SERIALIZE(DegreeState, (enabled)(rebuilding)(source)(cursor))
+    };
+
+    // Number of edges with one name leaving or entering a node. Rows are keyed by document hash,
+    // so replacing a node moves its counters, and a row is erased when its count drops to zero.
+    struct EdgeCounter
+    {
+        std::uint64_t id;
+        eosio::checksum256 node;
+        eosio::name edge_name;
+        std::uint8_t direction;
+        std::uint64_t count = 0;
+
+        uint64_t primary_key() const { return id; }
+        uint64_t by_node_name() const;
+        eosio::checksum256 by_node() const { return node; }
+
+        EOSLIB_SERIALIZE(EdgeCounter, (id)(node)(edge_name)(direction)(count))
+
+        typedef eosio::multi_index<eosio::name("edgecounts"), EdgeCounter,
+                                   eosio::indexed_by<eosio::name("bynodename"), eosio::const_mem_fun<EdgeCounter, uint64_t, &EdgeCounter::by_node_name>>,
+                                   eosio::indexed_by<eosio::name("bynode"), eosio::const_mem_fun<EdgeCounter, eosio::checksum256, &EdgeCounter::by_node>>>
+            counter_table;
+
+        static uint64_t get(const eosio::name &contract, const eosio::checksum256 &node,
+                            const eosio::name &edgeName, EdgeDirection direction);
+
+        // adds delta to the out counter of fromNode and the in counter of toNode, if the
+        // counters include the row with this id in source
+        static void adjust(const eosio::name &contract, std::uint8_t source, uint64_t id,
+                           const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                           const eosio::name &edgeName, int64_t delta);
+
+        // adds delta to one counter, ignoring whether any row is counted
+        static void add(counter_table &c_t, const eosio::name &contract, const eosio::checksum256 &node,
+                        const eosio::name &edgeName, EdgeDirection direction, int64_t delta);
+
+        // moves every counter of oldNode to newNode
+        static void moveNode(const eosio::name &contract, const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode);
+    };
+
+} // namespace hypha
\ No newline at end of file
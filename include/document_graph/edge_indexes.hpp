@@ -0,0 +1,32 @@
+#pragma once
+
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+
+#include <document_graph/node_edge.hpp>
+
+namespace hypha
+{
+    struct Edge;
+
+    // Tables derived from the edge rows: degree counters and ancestry closures. Each is built
+    // over existing edges behind a cursor, so whether it includes a row depends on the table
+    // holding the row and its id. Every write and removal of an edge row is reported here.
+    struct EdgeIndexes
+    {
+        // tables holding edge rows, in build order
+        static constexpr std::uint8_t NODE_EDGES = 0;
+        static constexpr std::uint8_t EDGES = 1;
+
+        // delta is 1 for a row written and -1 for a row removed
+        static void adjust(const eosio::name &contract, std::uint8_t source, uint64_t id,
+                           const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                           const eosio::name &edgeName, int64_t delta);
+        static void adjust(const eosio::name &contract, const Edge &edge, int64_t delta);
+        static void adjust(const eosio::name &contract, const NodeEdge &nodeEdge, int64_t delta);
+
+        // the document of oldNode now has the hash newNode and keeps its edges
+        static void renameNode(const eosio::name &contract, const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode);
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <eosio/crypto.hpp>
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+
+#include <document_graph/edge.hpp>
+
+namespace hypha
+{
+    // Position of an EdgeRange walk, to continue it in a later call or action. Rows sharing an
+    // index key are ordered by primary key, so the cursor is the last visited id in its source.
+    struct EdgeCursor
+    {
+        // 0 for the nodeedges table, otherwise the key version of the edges table rows
+        std::uint8_t source = 0;
+        std::uint64_t last_id = 0;
+        // false until the walk visited an edge
+        bool started = false;
+        // set once the walk reached the end of the range
+        bool done = false;
+
+        EOSLIB_SERIALIZE(EdgeCursor, (source)(last_id)(started)(done))
+    };
+
+    // An edge visited by EdgeRange, referring to the row in either edge table without copying
+    // it. Node hashes of nodeedges rows are looked up only when asked for.
+    class EdgeRef
+    {
+    public:
+        EdgeRef(const eosio::name &contract, const Edge &edge) : m_contract(contract), m_edge(&edge) {}
+        EdgeRef(const eosio::name &contract, const NodeEdge &nodeEdge,
+                const eosio::checksum256 *fromNode, const eosio::checksum256 *toNode)
+            : m_contract(contract), m_nodeEdge(&nodeEdge), m_fromNode(fromNode), m_toNode(toNode) {}
+
+        uint64_t getId() const { return m_edge ? m_edge->id : m_nodeEdge->id; }
+        const eosio::name &getEdgeName() const { return m_edge ? m_edge->edge_name : m_nodeEdge->edge_name; }
+        const eosio::time_point &getCreated() const { return m_edge ? m_edge->created_date : m_nodeEdge->created_date; }
+        const eosio::name &getCreator() const { return m_edge ? m_edge->creator : m_nodeEdge->creator; }
+        eosio::checksum256 getFromNode() const;
+        eosio::checksum256 getToNode() const;
+
+        Edge toEdge() const;
+
+    private:
+        eosio::name m_contract;
+        const Edge *m_edge = nullptr;
+        const NodeEdge *m_nodeEdge = nullptr;
+        // hashes the range already knows for nodeedges rows
+        const eosio::checksum256 *m_fromNode = nullptr;
+        const eosio::checksum256 *m_toNode = nullptr;
+    };
+
+    // The edges from a node with a name, to a node with a name, or between two nodes, read from
+    // the byfromname/bytoname/byfromto indexes only as far as a walk goes. Node id edges come
+    // first, then the edges table rows while it is still in use.
+    //
+    // A cursor resumes right after its last_id row, or by skipping the rows of its source up to
+    // last_id once that row is gone. Either is only stable while no edge key or node id migration
+    // moves rows between sources.
+    class EdgeRange
+    {
+    public:
+        static EdgeRange from(const eosio::name &contract, const eosio::checksum256 &fromNode, const eosio::name &edgeName);
+        static EdgeRange to(const eosio::name &contract, const eosio::checksum256 &toNode, const eosio::name &edgeName);
+        static EdgeRange between(const eosio::name &contract, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode);
+
+        // visit at most count edges
+        EdgeRange &limit(uint64_t count);
+        // continue after the position of an earlier walk
+        EdgeRange &after(const EdgeCursor &cursor);
+
+        // Calls visitor with each edge until it returns false or the limit is reached, and
+        // returns the position to continue from.
+        EdgeCursor visit(const std::function<bool(const EdgeRef &)> &visitor) const;
+        // as visit, also adding to rowsRead the index rows read: visited edges, rows skipped to
+        // resume a cursor whose row is gone, and edges table rows of colliding keys
+        EdgeCursor visit(const std::function<bool(const EdgeRef &)> &visitor, uint64_t &rowsRead) const;
+
+        // stops at the first edge
+        bool empty() const;
+        std::optional<Edge> first() const;
+        uint64_t count() const;
+        std::vector<Edge> toVector() const;
+
+    private:
+        enum class Kind
+        {
+            From,
+            To,
+            Between
+        };
+
+        EdgeRange(Kind kind, const eosio::name &contract, const eosio::checksum256 &node,
+                  const eosio::checksum256 &toNode, const eosio::name &edgeName);
+
+        // whether a row of the edges table belongs to the range, as composite keys can collide
+        bool matches(const Edge &edge) const;
+
+        Kind m_kind;
+        eosio::name m_contract;
+        // the from node, or the to node of a To range
+        eosio::checksum256 m_node;
+        eosio::checksum256 m_toNode;
+        eosio::name m_edgeName;
+        uint64_t m_limit = std::numeric_limits<uint64_t>::max();
+        EdgeCursor m_cursor;
+    };
+
+    enum class EdgeOrder : std::uint8_t
+    {
+        NewestFirst = 0,
+        OldestFirst = 1
+    };
+
+    // Position after the last edge of a page from DocumentGraph::edgesByTime
+    struct EdgeTimeCursor
+    {
+        eosio::time_point created_date;
+        std::uint64_t id = 0;
+    };
+
+    struct EdgePage
+    {
+        std::vector<Edge> edges;
+        // where the next page starts; unset once the walk reached the end
+        std::optional<EdgeTimeCursor> next;
+    };
+
+} // namespace hypha
\ No newline at end of file
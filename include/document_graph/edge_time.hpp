@@ -0,0 +1,59 @@
+#pragma once
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+#include <eosio/crypto.hpp>
+
+#include <document_graph/node_edge.hpp>
+
+namespace hypha
+{
+    // The edge time index is off until the contract builds it, which needs node id mode with
+    // the node id migration complete. The build walks the nodeedges table in primary key order;
+    // rows it has passed are kept indexed by edge writes, and pages can be read once it is done.
+    struct EdgeTimeState
+    {
+        bool enabled = false;
+        bool building = false;
+        // next nodeedges id the build indexes
+        std::uint64_t cursor = 0;
+
+        bool ready() const { return enabled && !building; }
+
+        // whether the index holds the nodeedges row with this id
+        bool indexes(uint64_t id) const { return enabled && (!building || id < cursor); }
+
+        EOSLIB_SERIALIZE(EdgeTimeState, (enabled)(building)(cursor))
+    };
+
+    // Orders the edges of a node with one name by creation time. Each row shares its id with
+    // a nodeedges row; the keys are (node id, edge name, created_date, id), so a page is a
+    // contiguous walk in either direction and the id breaks ties between edges created together.
+    struct EdgeTime
+    {
+        std::uint64_t id;
+        std::uint64_t from_node;
+        std::uint64_t to_node;
+        eosio::name edge_name;
+        eosio::time_point created_date;
+
+        uint64_t primary_key() const { return id; }
+        eosio::checksum256 by_from_time() const { return timeKey(from_node, edge_name, created_date, id); }
+        eosio::checksum256 by_to_time() const { return timeKey(to_node, edge_name, created_date, id); }
+
+        static eosio::checksum256 timeKey(uint64_t node, const eosio::name &edgeName, const eosio::time_point &created, uint64_t id);
+
+        EOSLIB_SERIALIZE(EdgeTime, (id)(from_node)(to_node)(edge_name)(created_date))
+
+        typedef eosio::multi_index<eosio::name("edgetimes"), EdgeTime,
+                                   eosio::indexed_by<eosio::name("byfromtime"), eosio::const_mem_fun<EdgeTime, eosio::checksum256, &EdgeTime::by_from_time>>,
+                                   eosio::indexed_by<eosio::name("bytotime"), eosio::const_mem_fun<EdgeTime, eosio::checksum256, &EdgeTime::by_to_time>>>
+            time_table;
+
+        // adds or updates the row of nodeEdge, if the index holds it
+        static void write(const eosio::name &contract, const NodeEdge &nodeEdge);
+        static void remove(const eosio::name &contract, uint64_t id);
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+
+#include <document_graph/content_wrapper.hpp>
+
+namespace hypha
+{
+    // One step of DocumentGraph::applyBatch. The fields used depend on type:
+    //   create      creator, content_groups
+    //   newedge     creator, from_node, to_node, edge_name
+    //   removeedge  from_node, to_node, edge_name
+    //   erase       from_node, the document erased along with its edges
+    // from_op/to_op, when set, replace from_node/to_node with the document created by that
+    // earlier operation of the same batch.
+    struct GraphOperation
+    {
+        eosio::name type;
+        eosio::name creator;
+        ContentGroups content_groups;
+        eosio::checksum256 from_node;
+        eosio::checksum256 to_node;
+        eosio::name edge_name;
+        std::optional<uint32_t> from_op;
+        std::optional<uint32_t> to_op;
+
+        EOSLIB_SERIALIZE(GraphOperation, (type)(creator)(content_groups)(from_node)(to_node)(edge_name)(from_op)(to_op))
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <eosio/name.hpp>
+#include <eosio/crypto.hpp>
+
+#include <document_graph/edge_counter.hpp>
+#include <document_graph/edge_range.hpp>
+
+namespace hypha
+{
+    enum class TraversalOrder : std::uint8_t
+    {
+        BreadthFirst = 0,
+        DepthFirst = 1
+    };
+
+    // What a traversal follows and how much it may do
+    struct TraversalSpec
+    {
+        TraversalOrder order = TraversalOrder::BreadthFirst;
+        // follow edges from (Out) or to (In) each node
+        EdgeDirection direction = EdgeDirection::Out;
+        // names followed at each hop; hops past the end use the last entry
+        std::vector<std::vector<eosio::name>> edge_names;
+        // hops from the start node
+        uint32_t max_depth = 1;
+        // the traversal ends once this many nodes, the start included, were reached
+        uint64_t max_visited = std::numeric_limits<uint64_t>::max();
+        // index rows a call may read before it returns a token to continue from; see
+        // EdgeRange::visit for what counts as a row read
+        uint64_t budget = std::numeric_limits<uint64_t>::max();
+    };
+
+    // A node waiting to be expanded, or being expanded: the edge name it is at and the
+    // position within that name's edges.
+    struct TraversalFrame
+    {
+        eosio::checksum256 node;
+        uint32_t depth = 0;
+        uint32_t name_index = 0;
+        EdgeCursor cursor;
+
+        EOSLIB_SERIALIZE(TraversalFrame, (node)(depth)(name_index)(cursor))
+    };
+
+    // The state of a traversal between calls. It can be stored or passed to a later action to
+    // continue with the same TraversalSpec; as with EdgeCursor, edge key or node id migrations
+    // must not run in between.
+    struct TraversalToken
+    {
+        std::optional<TraversalFrame> current;
+        std::vector<TraversalFrame> frontier;
+        // every node reached so far, with the fewest hops it was reached over
+        std::vector<std::pair<eosio::checksum256, uint32_t>> visited;
+        // index rows read by all calls so far
+        uint64_t edges_read = 0;
+        // set once there is nothing left to expand, the visitor stopped or max_visited was reached
+        bool done = false;
+
+        EOSLIB_SERIALIZE(TraversalToken, (current)(frontier)(visited)(edges_read)(done))
+    };
+
+    // Called for each node reached, with its depth and the edge that reached it; returns false
+    // to end the traversal.
+    using TraversalVisitor = std::function<bool(const eosio::checksum256 &node, uint32_t depth, const EdgeRef &edge)>;
+
+    // Walks the graph over EdgeRange, one edge name at a time, without copying edges. Nodes are
+    // marked visited with their depth when first reached. Breadth-first, that is their fewest
+    // hops, so each node is reported and expanded once. Depth-first can reach a node over a
+    // longer path first; reaching it again over fewer hops reports it again with that depth and
+    // expands it again, so both orders reach the same nodes within max_depth, expanded with the
+    // edge names of the same hop, and the last report of each node has its fewest hops.
+    class GraphTraversal
+    {
+    public:
+        // a token that has only the start node left to expand
+        static TraversalToken start(const eosio::checksum256 &node);
+
+        // continues token until it is done or spec.budget edges were read
+        static void run(const eosio::name &contract, TraversalToken &token,
+                        const TraversalSpec &spec, const TraversalVisitor &visitor);
+
+        // A shortest path of at most maxHops edges named in edgeNames, searched breadth-first
+        // from both ends at once, always growing the side with the smaller frontier. Returns
+        // the edges in order from fromNode, empty if the nodes are the same, or nothing.
+        static std::optional<std::vector<Edge>> findPath(const eosio::name &contract,
+                                                         const eosio::checksum256 &fromNode,
+                                                         const eosio::checksum256 &toNode,
+                                                         const std::vector<eosio::name> &edgeNames,
+                                                         const uint32_t maxHops);
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <optional>
+
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+#include <eosio/crypto.hpp>
+
+namespace hypha
+{
+    // Node id mode stores edges between stable uint64 node ids instead of document hashes.
+    // It is off until the contract starts the node id migration. From then on new edges go to
+    // the nodeedges table, and the migration moves the rows of the edges table over in batches;
+    // reads use both tables until it is done.
+    struct NodeIdState
+    {
+        bool enabled = false;
+        bool migrating = false;
+
+        // whether the edges table may still hold rows
+        bool legacyEdges() const { return !enabled || migrating; }
+
+        EOSLIB_SERIALIZE(NodeIdState, (enabled)(migrating))
+    };
+
+    // Stable identity of a document that takes part in edges. The row follows the document
+    // across updates: replacing a node only rewrites the hash here, the edges keep the id.
+    struct DocumentNode
+    {
+        std::uint64_t id;
+        eosio::checksum256 hash;
+
+        uint64_t primary_key() const { return id; }
+        eosio::checksum256 by_hash() const { return hash; }
+
+        EOSLIB_SERIALIZE(DocumentNode, (id)(hash))
+
+        typedef eosio::multi_index<eosio::name("docnodes"), DocumentNode,
+                                   eosio::indexed_by<eosio::name("idhash"), eosio::const_mem_fun<DocumentNode, eosio::checksum256, &DocumentNode::by_hash>>>
+            node_table;
+
+        // the id of the node for hash, if it has one
+        static std::optional<uint64_t> find(const eosio::name &contract, const eosio::checksum256 &hash);
+        static uint64_t getOrNew(const eosio::name &contract, const eosio::checksum256 &hash);
+        static eosio::checksum256 getHash(const eosio::name &contract, uint64_t id);
+    };
+
+    // An edge between two node ids. The keys combine a node id with an edge name or a second
+    // node id, so unlike the edges table they cannot collide.
+    struct NodeEdge
+    {
+        std::uint64_t id;
+        std::uint64_t from_node;
+        std::uint64_t to_node;
+        eosio::name edge_name;
+        eosio::time_point created_date;
+        eosio::name creator;
+
+        uint64_t primary_key() const { return id; }
+        uint128_t by_from_node_edge_name() const { return nodeKey(from_node, edge_name.value); }
+        uint128_t by_to_node_edge_name() const { return nodeKey(to_node, edge_name.value); }
+        uint128_t by_from_node_to_node() const { return nodeKey(from_node, to_node); }
+        uint64_t by_edge_name() const { return edge_name.value; }
+
+        static uint128_t nodeKey(uint64_t node, uint64_t second) { return (uint128_t(node) << 64) | second; }
+
+        EOSLIB_SERIALIZE(NodeEdge, (id)(from_node)(to_node)(edge_name)(created_date)(creator))
+
+        typedef eosio::multi_index<eosio::name("nodeedges"), NodeEdge,
+                                   eosio::indexed_by<eosio::name("byfromname"), eosio::const_mem_fun<NodeEdge, uint128_t, &NodeEdge::by_from_node_edge_name>>,
+                                   eosio::indexed_by<eosio::name("bytoname"), eosio::const_mem_fun<NodeEdge, uint128_t, &NodeEdge::by_to_node_edge_name>>,
+                                   eosio::indexed_by<eosio::name("byfromto"), eosio::const_mem_fun<NodeEdge, uint128_t, &NodeEdge::by_from_node_to_node>>,
+                                   eosio::indexed_by<eosio::name("edgename"), eosio::const_mem_fun<NodeEdge, uint64_t, &NodeEdge::by_edge_name>>>
+            node_edge_table;
+
+        // the row for this edge, or ne_t.end()
+        static node_edge_table::const_iterator find(const node_edge_table &ne_t, uint64_t fromNode, uint64_t toNode, const eosio::name &edgeName);
+    };
+
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <eosio/name.hpp>
+
+namespace hypha
+{
+    // Cached reads and writes of the state singletons. Contracts run every action in a fresh
+    // instance, so this caches for one action; each State type has one cache.
+    template <typename State>
+    struct StateCache
+    {
+        bool loaded = false;
+        eosio::name contract;
+        State state;
+    };
+
+    template <typename State>
+    StateCache<State> &stateCache()
+    {
+        static StateCache<State> cache;
+        return cache;
+    }
+
+    template <typename Singleton, typename State>
+    const State &getCachedState(const eosio::name &contract)
+    {
+        StateCache<State> &cache = stateCache<State>();
+        if (!cache.loaded || cache.contract != contract)
+        {
+            Singleton singleton(contract, contract.value);
+            cache.state = singleton.get_or_default(State{});
+            cache.contract = contract;
+            cache.loaded = true;
+        }
+        return cache.state;
+    }
+
+    template <typename Singleton, typename State>
+    void setCachedState(const eosio::name &contract, const State &state)
+    {
+        Singleton singleton(contract, contract.value);
+        singleton.set(state, contract);
+
+        StateCache<State> &cache = stateCache<State>();
+        cache.state = state;
+        cache.contract = contract;
+        cache.loaded = true;
+    }
+} // namespace hypha
\ No newline at end of file
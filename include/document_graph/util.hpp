@@ -14,6 +14,12 @@ namespace hypha
     const std::uint64_t concatHash(const eosio::checksum256 sha1, const eosio::checksum256 sha2);
     const std::uint64_t concatHash(const eosio::checksum256 sha, const eosio::name label);
 
+    // v2 composite keys: sha256 over the raw 32-byte digests and the 64-bit name value,
+    // keeping all 8 leading bytes of the result instead of 4
+    const std::uint64_t compositeKey(const eosio::checksum256 &sha1, const eosio::checksum256 &sha2, const eosio::name &label);
+    const std::uint64_t compositeKey(const eosio::checksum256 &sha1, const eosio::checksum256 &sha2);
+    const std::uint64_t compositeKey(const eosio::checksum256 &sha, const eosio::name &label);
+
   namespace util
   {    
     namespace detail 
@@ -60,7 +60,14 @@ if (!(condition)) {\
 #define TRACE_FUNCTION()
 #define TRACE_ERROR(message)
 #define LOG_MESSAGE(message)
-#define EOS_CHECK(condition, message) eosio::check((condition), message);
+// the message expression is only evaluated when the check fails, so callers can build
+// descriptive messages (hex hashes, concatenations) without paying for them on success
+#define EOS_CHECK(condition, message)\
+{\
+if (!(condition)) {\
+  eosio::check(false, message);\
+}\
+}
 #endif 
 
 }
@@ -2,6 +2,27 @@
 
 namespace hypha
 {
+   namespace
+   {
+      // the labelled group of examples/each-type.json
+      struct EachType
+      {
+         asset salary_amount;
+         name referrer;
+         int64_t vote_count;
+         checksum256 reference_link;
+         std::optional<std::string> notes;
+
+         static constexpr auto schema()
+         {
+            return std::make_tuple(schemaField("My Content Group Label", "salary_amount", &EachType::salary_amount),
+                                   schemaField("My Content Group Label", "referrer", &EachType::referrer),
+                                   schemaField("My Content Group Label", "vote_count", &EachType::vote_count),
+                                   schemaField("My Content Group Label", "reference_link", &EachType::reference_link),
+                                   schemaField("My Content Group Label", "notes", &EachType::notes));
+         }
+      };
+   } // namespace
 
    docs::docs(name self, name code, datastream<const char *> ds) : contract(self, code, ds) {}
    docs::~docs() {}
@@ -19,13 +40,22 @@ namespace hypha
 
    void docs::getornewnew(const name &creator, ContentGroups &content_groups)
    {
-      bool docExists = Document::exists(get_self(), Document::hashContents(content_groups));
+      bool docExists = Document::exists(get_self(), Document::hashContents(get_self(), content_groups));
       check(!docExists, "document already exists");
 
       Document document = Document::getOrNew(get_self(), creator, content_groups);
       eosio::check(document.getCreated().sec_since_epoch() > 0, "created_date not populated when saved");
    }
 
+   void docs::mergedoc(const name &updater, const checksum256 &hash, ContentGroups &deltas)
+   {
+      Document deltasDocument;
+      deltasDocument.getContentGroups() = std::move(deltas);
+
+      DocumentGraph dg(get_self());
+      eosio::print(readableHash(dg.mergeDocument(updater, hash, deltasDocument).getHash()));
+   }
+
    void docs::newedge(name &creator, const checksum256 &from_node, const checksum256 &to_node, const name &edge_name)
    {
       Edge edge(get_self(), creator, from_node, to_node, edge_name);
@@ -37,12 +67,125 @@ namespace hypha
       edge.erase();
    }
 
+   void docs::batch(const std::vector<GraphOperation> &operations)
+   {
+      DocumentGraph dg(get_self());
+      for (const checksum256 &hash : dg.applyBatch(operations))
+      {
+         eosio::print(readableHash(hash) + " ");
+      }
+   }
+
    void docs::erase(const checksum256 &hash)
    {
       DocumentGraph dg(get_self());
       dg.eraseDocument(hash);
    }
 
+   void docs::erasebatch(const checksum256 &hash, const uint64_t &batch_size)
+   {
+      DocumentGraph dg(get_self());
+      if (dg.eraseDocumentInBatches(hash, batch_size))
+      {
+         eosio::print("document erase complete");
+         return;
+      }
+
+      PendingDeletion deletion = *dg.getPendingDeletion(hash);
+      eosio::print("document erase pending: removed " + std::to_string(deletion.edges_removed) +
+                   " edges in " + std::to_string(deletion.batches) + " batches");
+   }
+
+   void docs::migedgekeys(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.migrateEdgeKeys(batch_size) ? "edge key migration complete" : "edge key migration pending");
+   }
+
+   void docs::migdockeys(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.migrateDocumentKeys(batch_size) ? "document key migration complete" : "document key migration pending");
+   }
+
+   void docs::migdocheads(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.migrateDocumentHeaders(batch_size) ? "document header migration complete" : "document header migration pending");
+   }
+
+   void docs::mignodeids(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.migrateNodeIds(batch_size) ? "node id migration complete" : "node id migration pending");
+   }
+
+   void docs::rebuilddeg(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.rebuildDegrees(batch_size) ? "degree rebuild complete" : "degree rebuild pending");
+   }
+
+   void docs::idxedgetimes(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.buildEdgeTimes(batch_size) ? "edge time index complete" : "edge time index pending");
+   }
+
+   void docs::buildclosure(const name &edge_name, const uint64_t &max_updates, const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      eosio::print(dg.buildClosure(edge_name, max_updates, batch_size) ? "closure build complete" : "closure build pending");
+   }
+
+   void docs::setstorage(const bool &group_storage)
+   {
+      require_auth(get_self());
+
+      DocumentStorageState state;
+      state.group_storage = group_storage;
+      Document::setStorageState(get_self(), state);
+   }
+
+   void docs::sethashver(const uint8_t &hash_version)
+   {
+      require_auth(get_self());
+      check(hash_version == 1 || hash_version == 2, "unknown document hash version: " + std::to_string(hash_version));
+
+      DocumentHashState state;
+      state.hash_version = hash_version;
+      Document::setHashState(get_self(), state);
+   }
+
+   void docs::auditdocs(const uint64_t &batch_size)
+   {
+      require_auth(get_self());
+
+      DocumentGraph dg(get_self());
+      DocumentAuditState state = dg.auditDocuments(batch_size);
+      eosio::print("document audit " + std::string(state.running ? "pending" : "complete") +
+                   ": checked " + std::to_string(state.checked) +
+                   ", mismatches " + std::to_string(state.mismatches));
+      if (state.mismatches > 0)
+      {
+         eosio::print(", last mismatch " + readableHash(state.last_mismatch));
+      }
+   }
+
    void docs::testgetasset(const checksum256 &hash,
                            const std::string &groupLabel,
                            const std::string &contentLabel,
@@ -69,6 +212,41 @@ namespace hypha
       check(idx > -1, "group was not found");
    }
    
+   void docs::testviewast(const checksum256 &hash,
+                          const std::string &groupLabel,
+                          const std::string &contentLabel,
+                          const asset &contentValue)
+   {
+      DocumentView view(get_self(), hash);
+      Document document(get_self(), hash);
+
+      // both read paths must agree before the value is checked
+      std::optional<Content> viewContent = view.get(groupLabel, contentLabel);
+      auto [idx, content] = document.getContentWrapper().get(groupLabel, contentLabel);
+      check(viewContent.has_value() == (content != nullptr), "DocumentView and Document disagree on whether the content exists");
+      check(viewContent.has_value(), "contentGroup or contentLabel does not exist");
+      check(viewContent->label == content->label && viewContent->value == content->value,
+            "DocumentView and Document read different values");
+
+      asset readValue = viewContent->getAs<eosio::asset>();
+      eosio::check(readValue == contentValue, "read value does not equal content value. read value: " +
+                                                  readValue.to_string() + " expected value: " + contentValue.to_string());
+      eosio::print(" testviewast:: asset found: " + readValue.to_string() + "\n");
+   }
+
+   void docs::testviewgrp(const checksum256 &hash,
+                          const std::string &groupLabel)
+   {
+      DocumentView view(get_self(), hash);
+      Document document(get_self(), hash);
+
+      std::optional<ContentGroup> viewGroup = view.getGroup(groupLabel);
+      auto [idx, contentGroup] = document.getContentWrapper().getGroup(groupLabel);
+      check(viewGroup.has_value() == (idx > -1), "DocumentView and Document disagree on whether the group exists");
+      check(viewGroup.has_value(), "group was not found");
+      check(eosio::pack(*viewGroup) == eosio::pack(*contentGroup), "DocumentView and Document read different groups");
+   }
+
    void docs::testcntnterr(string test) 
    {
      ContentGroups cgs{
@@ -82,6 +260,310 @@ namespace hypha
      cw.getOrFail("test", "test_label")->getAs<int64_t>();
    }
 
+   void docs::testindexed(const checksum256 &hash)
+   {
+      Document document(get_self(), hash);
+      ContentGroups plainGroups = document.getContentGroups();
+      ContentGroups indexedGroups = document.getContentGroups();
+      ContentWrapper plain(plainGroups);
+      ContentWrapper indexed(indexedGroups, true);
+      check(indexed.isIndexed() && !plain.isIndexed(), "wrong ContentWrapper modes");
+
+      // every label of the document, the ones the edits add, and one that is never there
+      std::vector<std::string> groupLabels{"appended", "relabelled", "missing"};
+      std::vector<std::string> itemLabels{CONTENT_GROUP_LABEL, "added", "missing"};
+      for (const ContentGroup &contentGroup : document.getContentGroups())
+      {
+         groupLabels.emplace_back(ContentWrapper::getGroupLabel(contentGroup));
+         for (const Content &content : contentGroup)
+         {
+            itemLabels.push_back(content.label);
+         }
+      }
+
+      auto compare = [&](const std::string &step) {
+         check(eosio::pack(plainGroups) == eosio::pack(indexedGroups), step + ": the edits left different groups");
+         for (const std::string &groupLabel : groupLabels)
+         {
+            check(plain.getGroup(groupLabel).first == indexed.getGroup(groupLabel).first,
+                  step + ": group " + groupLabel + " found at different positions");
+            for (const std::string &itemLabel : itemLabels)
+            {
+               check(plain.get(groupLabel, itemLabel).first == indexed.get(groupLabel, itemLabel).first,
+                     step + ": group " + groupLabel + " item " + itemLabel + " found at different positions");
+            }
+         }
+         for (size_t i = 0; i < plainGroups.size(); ++i)
+         {
+            for (const std::string &itemLabel : itemLabels)
+            {
+               check(plain.get(i, itemLabel).first == indexed.get(i, itemLabel).first,
+                     step + ": group index " + std::to_string(i) + " item " + itemLabel + " found at different positions");
+            }
+         }
+      };
+      compare("before any edit");
+
+      // the label item of the first labelled group, which unlabels it
+      for (size_t i = 0; i < plainGroups.size(); ++i)
+      {
+         if (int64_t item = plain.get(i, CONTENT_GROUP_LABEL).first; item != -1)
+         {
+            plain.removeContent(i, item);
+            indexed.removeContent(i, item);
+            break;
+         }
+      }
+      compare("after removing a group label item");
+
+      if (!plainGroups.empty())
+      {
+         plain.removeGroup(size_t(0));
+         indexed.removeGroup(size_t(0));
+      }
+      compare("after removing the first group");
+
+      int64_t appended = plain.getGroupOrCreate("appended").first;
+      check(indexed.getGroupOrCreate("appended").first == appended, "appended groups at different positions");
+      plain.insertOrReplace(appended, Content{"added", int64_t(1)});
+      indexed.insertOrReplace(appended, Content{"added", int64_t(1)});
+      compare("after appending a group");
+
+      plain.insertOrReplace(0, Content{CONTENT_GROUP_LABEL, std::string("relabelled")});
+      indexed.insertOrReplace(0, Content{CONTENT_GROUP_LABEL, std::string("relabelled")});
+      compare("after relabelling the first group");
+   }
+
+   void docs::testfields(const checksum256 &hash, const std::string &groupLabel,
+                         const std::string &firstAsset, const std::string &nameLabel, const std::string &secondAsset,
+                         const bool &indexed)
+   {
+      Document document(get_self(), hash);
+      ContentWrapper cw(document.getContentGroups(), indexed);
+
+      auto [first, account, second] = cw.getFieldsOrFail<asset, name, asset>(groupLabel, {firstAsset, nameLabel, secondAsset});
+
+      // the fields are the items a lookup by label finds, not copies of them
+      check(&first == &std::get<asset>(cw.getOrFail(groupLabel, firstAsset)->value), "field " + firstAsset + " is not the item with its label");
+      check(&account == &std::get<name>(cw.getOrFail(groupLabel, nameLabel)->value), "field " + nameLabel + " is not the item with its label");
+      check(&second == &std::get<asset>(cw.getOrFail(groupLabel, secondAsset)->value), "field " + secondAsset + " is not the item with its label");
+      check((firstAsset == secondAsset) == (&first == &second), "a label requested twice did not read the same item");
+   }
+
+   void docs::testschema(const checksum256 &hash)
+   {
+      Document document(get_self(), hash);
+      EachType decoded = DocumentSchema<EachType>::decode(document.getContentGroups());
+      check(!decoded.notes, "decoded an item the document does not have");
+
+      ContentGroups encoded = DocumentSchema<EachType>::encode(decoded);
+      check(encoded.size() == 1, "encoded " + std::to_string(encoded.size()) + " groups, expected 1");
+      check(eosio::pack(encoded[0]) == eosio::pack(document.getContentGroups()[0]), "encoded group differs from the document's");
+
+      EachType again = DocumentSchema<EachType>::decode(encoded);
+      check(again.salary_amount == decoded.salary_amount && again.referrer == decoded.referrer &&
+                again.vote_count == decoded.vote_count && again.reference_link == decoded.reference_link && !again.notes,
+            "decoding the encoded groups gave other values");
+   }
+
+   void docs::testrange(const checksum256 &node, const name &edge_name, const uint64_t &page_size, const uint64_t &expected_count)
+   {
+      check(page_size > 0, "page_size must be positive");
+      DocumentGraph dg(get_self());
+
+      std::vector<Edge> all = dg.edgesFrom(node, edge_name).toVector();
+      check(all.size() == expected_count, "edge range has " + std::to_string(all.size()) + " edges, expected " + std::to_string(expected_count));
+
+      // a limit of zero visits nothing and does not finish the walk
+      EdgeCursor cursor = dg.edgesFrom(node, edge_name).limit(0).visit([](const EdgeRef &) { return true; });
+      check(!cursor.started && !cursor.done, "a zero limit moved the cursor");
+
+      std::vector<checksum256> paged;
+      for (uint64_t pages = 0; !cursor.done; ++pages)
+      {
+         check(pages <= expected_count, "paged edge walk did not finish");
+
+         uint64_t visited = 0;
+         cursor = dg.edgesFrom(node, edge_name).limit(page_size).after(cursor).visit([&](const EdgeRef &edge) {
+            paged.push_back(edge.getToNode());
+            visited++;
+            return true;
+         });
+         check(visited == page_size || cursor.done, "a page before the end of the range is short");
+      }
+
+      check(paged.size() == all.size(), "paged edge walk visited " + std::to_string(paged.size()) + " edges, expected " + std::to_string(all.size()));
+      for (size_t i = 0; i < all.size(); ++i)
+      {
+         check(paged[i] == all[i].to_node, "paged edge walk differs at edge " + std::to_string(i));
+      }
+
+      // a finished cursor visits nothing more
+      bool visitedAfterDone = false;
+      dg.edgesFrom(node, edge_name).after(cursor).visit([&](const EdgeRef &) {
+         visitedAfterDone = true;
+         return true;
+      });
+      check(!visitedAfterDone, "a finished cursor visited another edge");
+   }
+
+   void docs::testtraverse(const checksum256 &start, const std::vector<name> &edge_names, const uint8_t &order,
+                           const uint32_t &max_depth, const uint64_t &max_visited, const uint64_t &budget,
+                           const uint64_t &stop_after, const uint64_t &expected_nodes)
+   {
+      check(budget > 0, "budget must be positive");
+      check(order <= static_cast<uint8_t>(TraversalOrder::DepthFirst), "unknown traversal order: " + std::to_string(order));
+
+      TraversalSpec spec;
+      spec.order = static_cast<TraversalOrder>(order);
+      for (const name &edge_name : edge_names)
+      {
+         spec.edge_names.push_back({edge_name});
+      }
+      spec.max_depth = max_depth;
+      spec.max_visited = max_visited;
+
+      // the visitor stops the traversal once it was called stop_after times, unless that is 0
+      using Reached = std::vector<std::pair<checksum256, uint32_t>>;
+      auto traverse = [&](Reached &reached) {
+         return [&](const checksum256 &node, uint32_t depth, const EdgeRef &edge) {
+            check(depth > 0 && depth <= max_depth, "traversal reported a node at depth " + std::to_string(depth));
+            reached.emplace_back(node, depth);
+            return stop_after == 0 || reached.size() < stop_after;
+         };
+      };
+
+      // a node reported again was reached over fewer hops, so its last report has its depth
+      auto depths = [](const Reached &reached) {
+         std::map<checksum256, uint32_t> depth;
+         for (const auto &[node, hops] : reached)
+         {
+            auto itr = depth.find(node);
+            check(itr == depth.end() || hops < itr->second, "traversal reported a node again without fewer hops");
+            depth[node] = hops;
+         }
+         return depth;
+      };
+
+      Reached unbudgeted;
+      TraversalToken whole = GraphTraversal::start(start);
+      GraphTraversal::run(get_self(), whole, spec, traverse(unbudgeted));
+      check(whole.done, "unbudgeted traversal did not finish");
+
+      // each call continues from a token that went through serialization, as one from an earlier action would
+      spec.budget = budget;
+      Reached resumed;
+      std::vector<char> packed = eosio::pack(GraphTraversal::start(start));
+      for (uint64_t calls = 0;; ++calls)
+      {
+         check(calls <= whole.edges_read, "budgeted traversal did not finish");
+
+         TraversalToken token = eosio::unpack<TraversalToken>(packed);
+         const uint64_t before = token.edges_read;
+         GraphTraversal::run(get_self(), token, spec, traverse(resumed));
+         check(token.edges_read - before <= budget, "a traversal call read " + std::to_string(token.edges_read - before) +
+                                                        " rows with a budget of " + std::to_string(budget));
+         if (token.done)
+         {
+            check(token.edges_read == whole.edges_read, "budgeted traversal read " + std::to_string(token.edges_read) +
+                                                            " rows, unbudgeted " + std::to_string(whole.edges_read));
+            break;
+         }
+         packed = eosio::pack(token);
+      }
+
+      const std::map<checksum256, uint32_t> reached = depths(unbudgeted);
+      check(reached.size() == expected_nodes, "traversal reached " + std::to_string(reached.size()) +
+                                                  " nodes, expected " + std::to_string(expected_nodes));
+      check(resumed == unbudgeted, "budgeted traversal reached different nodes than an unbudgeted one");
+
+      // max_visited counts the start node
+      if (stop_after == 0 && reached.size() + 1 < max_visited)
+      {
+         spec.order = TraversalOrder::BreadthFirst;
+         spec.budget = std::numeric_limits<uint64_t>::max();
+         Reached breadthFirst;
+         TraversalToken token = GraphTraversal::start(start);
+         GraphTraversal::run(get_self(), token, spec, traverse(breadthFirst));
+         check(depths(breadthFirst) == reached, "traversal reached different nodes or depths than a breadth-first one");
+      }
+   }
+
+   void docs::testpath(const checksum256 &from_node, const checksum256 &to_node, const std::vector<name> &edge_names,
+                       const uint32_t &max_hops, const bool &reachable, const uint32_t &expected_hops)
+   {
+      DocumentGraph dg(get_self());
+      check(dg.isReachable(from_node, to_node, edge_names, max_hops) == reachable,
+            reachable ? "to_node is not reachable from from_node" : "to_node is reachable from from_node");
+
+      std::optional<std::vector<Edge>> path = dg.findPath(from_node, to_node, edge_names, max_hops);
+      if (!reachable)
+      {
+         check(!path, "found a path to an unreachable node");
+         return;
+      }
+
+      check(path && path->size() == expected_hops, "path has " + std::to_string(path ? path->size() : 0) +
+                                                       " edges, expected " + std::to_string(expected_hops));
+
+      checksum256 node = from_node;
+      for (const Edge &edge : *path)
+      {
+         check(edge.from_node == node, "path edges do not connect");
+         check(std::find(edge_names.begin(), edge_names.end(), edge.edge_name) != edge_names.end(),
+               "path follows an edge named " + edge.edge_name.to_string());
+         check(Edge::exists(get_self(), edge.from_node, edge.to_node, edge.edge_name), "path follows an edge that does not exist");
+         node = edge.to_node;
+      }
+      check(node == to_node, "path does not end at to_node");
+   }
+
+   void docs::testreplace(const checksum256 &old_node, const checksum256 &new_node, const uint64_t &expected_rows)
+   {
+      DocumentGraph dg(get_self());
+      uint64_t rows = dg.replaceNode(old_node, new_node);
+      check(rows == expected_rows, "replaceNode rewrote " + std::to_string(rows) + " edge rows, expected " + std::to_string(expected_rows));
+      check(!dg.hasEdges(old_node), "old node still has edges after replaceNode");
+   }
+
+   void docs::testcache(const checksum256 &hash, ContentGroups &first, ContentGroups &second)
+   {
+      DocumentGraph dg(get_self());
+
+      // a miss loads the document, a second read is served from the cache
+      const Document &original = dg.getDocument(hash);
+      check(&dg.getDocument(hash) == &original, "second read was not served from the cache");
+      check(dg.getCacheStats().hits == 1 && dg.getCacheStats().misses == 1, "unexpected cache stats after two reads");
+
+      // the update erases the original, which drops it from the cache
+      Document firstVersion = dg.updateDocument(get_self(), hash, first);
+      check(!Document::exists(get_self(), hash), "original document still exists after update");
+
+      Document secondVersion = dg.updateDocument(get_self(), firstVersion.getHash(), second);
+      check(!Document::exists(get_self(), firstVersion.getHash()), "first version still exists after update");
+      check(dg.getDocument(secondVersion.getHash()).getHash() == secondVersion.getHash(), "second version not readable");
+
+      dg.eraseDocument(secondVersion.getHash());
+      check(!Document::exists(get_self(), secondVersion.getHash()), "second version still exists after erase");
+
+      // the first update read the original from the cache, and each version was loaded once
+      check(dg.getCacheStats().hits == 2 && dg.getCacheStats().misses == 3,
+            "unexpected cache stats: " + std::to_string(dg.getCacheStats().hits) + " hits, " +
+                std::to_string(dg.getCacheStats().misses) + " misses");
+   }
+
+   void docs::testdiff(const checksum256 &original, const checksum256 &updated)
+   {
+      Document from(get_self(), original);
+      Document to(get_self(), updated);
+
+      Document deltas;
+      deltas.getContentGroups() = Document::diff(from.getContentGroups(), to.getContentGroups());
+      Document merged = Document::merge(from, deltas);
+      check(eosio::pack(merged.getContentGroups()) == eosio::pack(to.getContentGroups()),
+            "merging the diff into original does not give the groups of updated");
+   }
+
    void docs::createroot(const std::string &notes)
    {
       require_auth(get_self());
@@ -1,6 +1,9 @@
 #include <document_graph/content.hpp>
 #include <document_graph/util.hpp>
 
+#include <cstring>
+#include <string_view>
+
 namespace hypha
 {
 
@@ -16,39 +19,151 @@ namespace hypha
         return false;
     }
 
-    const std::string Content::toString() const
+    namespace
+    {
+        std::size_t digitCount(std::uint64_t value)
+        {
+            std::size_t digits = 1;
+            while (value >= 10)
+            {
+                value /= 10;
+                ++digits;
+            }
+            return digits;
+        }
+
+        // writes the same characters as std::to_string
+        char *writeDigits(char *out, std::uint64_t value, bool negative)
+        {
+            if (negative)
+            {
+                *out++ = '-';
+            }
+            char *end = out + digitCount(value);
+            char *p = end;
+            do
+            {
+                *--p = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            return end;
+        }
+
+        std::uint64_t magnitude(std::int64_t value)
+        {
+            return value < 0 ? ~static_cast<std::uint64_t>(value) + 1 : static_cast<std::uint64_t>(value);
+        }
+
+        char *writeText(char *out, std::string_view text)
+        {
+            std::memcpy(out, text.data(), text.size());
+            return out + text.size();
+        }
+
+        // the type tag of each non-empty FlexValue alternative, as it appears in the fingerprint
+        std::string_view typeTag(const Content::FlexValue &value)
+        {
+            if (std::holds_alternative<std::int64_t>(value)) return "int64";
+            if (std::holds_alternative<eosio::asset>(value)) return "asset";
+            if (std::holds_alternative<eosio::time_point>(value)) return "time_point";
+            if (std::holds_alternative<std::string>(value)) return "string";
+            if (std::holds_alternative<eosio::checksum256>(value)) return "checksum256";
+            return "name";
+        }
+
+        constexpr std::size_t CHECKSUM_HEX_SIZE = 64;
+    } // namespace
+
+    // {label=[type,value]}
+    std::size_t Content::canonicalSize() const
+    {
+        if (isEmpty()) return 0;
+
+        std::size_t size = label.size() + typeTag(value).size() + 6;
+        if (std::holds_alternative<std::int64_t>(value))
+        {
+            std::int64_t v = std::get<std::int64_t>(value);
+            size += digitCount(magnitude(v)) + (v < 0 ? 1 : 0);
+        }
+        else if (std::holds_alternative<eosio::asset>(value))
+        {
+            size += std::get<eosio::asset>(value).write_as_string(nullptr, nullptr, true) - static_cast<char *>(nullptr);
+        }
+        else if (std::holds_alternative<eosio::time_point>(value))
+        {
+            size += digitCount(std::get<eosio::time_point>(value).sec_since_epoch());
+        }
+        else if (std::holds_alternative<std::string>(value))
+        {
+            size += std::get<std::string>(value).size();
+        }
+        else if (std::holds_alternative<eosio::checksum256>(value))
+        {
+            size += CHECKSUM_HEX_SIZE;
+        }
+        else
+        {
+            size += std::get<eosio::name>(value).length();
+        }
+        return size;
+    }
+
+    // writes exactly canonicalSize() bytes and returns the end of the written range
+    char *Content::writeCanonical(char *out) const
     {
-        if (isEmpty()) return "";
-        
-        std::string str = "{" + std::string(label) + "=";
+        if (isEmpty()) return out;
+
+        *out++ = '{';
+        out = writeText(out, label);
+        *out++ = '=';
+        *out++ = '[';
+        out = writeText(out, typeTag(value));
+        *out++ = ',';
+
         if (std::holds_alternative<std::int64_t>(value))
         {
-            str += "[int64," + std::to_string(std::get<std::int64_t>(value)) + "]";
+            std::int64_t v = std::get<std::int64_t>(value);
+            out = writeDigits(out, magnitude(v), v < 0);
         }
         else if (std::holds_alternative<eosio::asset>(value))
         {
-            str += "[asset," + std::get<eosio::asset>(value).to_string() + "]";
+            const eosio::asset &a = std::get<eosio::asset>(value);
+            char *end = a.write_as_string(nullptr, nullptr, true);
+            out = a.write_as_string(out, out + (end - static_cast<char *>(nullptr)));
         }
         else if (std::holds_alternative<eosio::time_point>(value))
         {
-            str += "[time_point," + std::to_string(std::get<eosio::time_point>(value).sec_since_epoch()) + "]";
+            out = writeDigits(out, std::get<eosio::time_point>(value).sec_since_epoch(), false);
         }
         else if (std::holds_alternative<std::string>(value))
         {
-            str += "[string," + std::get<std::string>(value) + "]";
+            out = writeText(out, std::get<std::string>(value));
         }
         else if (std::holds_alternative<eosio::checksum256>(value))
         {
-            eosio::checksum256 cs_value = std::get<eosio::checksum256>(value);
-            auto arr = cs_value.extract_as_byte_array();
-            std::string str_value = toHex((const char *)arr.data(), arr.size());
-            str += "[checksum256," + str_value + "]";
+            static const char *to_hex = "0123456789abcdef";
+            auto arr = std::get<eosio::checksum256>(value).extract_as_byte_array();
+            for (std::uint8_t byte : arr)
+            {
+                *out++ = to_hex[byte >> 4];
+                *out++ = to_hex[byte & 0x0f];
+            }
         }
         else
         {
-            str += "[name," + std::get<eosio::name>(value).to_string() + "]";
+            const eosio::name &n = std::get<eosio::name>(value);
+            out = n.write_as_string(out, out + n.length());
         }
-        str += "}";
+
+        *out++ = ']';
+        *out++ = '}';
+        return out;
+    }
+
+    const std::string Content::toString() const
+    {
+        std::string str(canonicalSize(), '\0');
+        writeCanonical(str.data());
         return str;
     }
 } // namespace hypha
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <eosio/eosio.hpp>
 
 #include <algorithm>
+#include <cstring>
 
 #include <document_graph/content_wrapper.hpp>
 #include <document_graph/content.hpp>
@@ -9,12 +10,101 @@
 namespace hypha
 {
 
+namespace
+{
+// mixes the label in 8 byte words; labels are short, so this is a few multiplications
+uint64_t labelHash(string_view label)
+{
+  uint64_t hash = label.size() * 0x9e3779b97f4a7c15ull;
+  size_t i = 0;
+  for (; i + 8 <= label.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, label.data() + i, 8);
+    hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, label.data() + i, label.size() - i);
+  hash = (hash ^ tail) * 0xff51afd7ed558ccdull;
+  return hash ^ (hash >> 32);
+}
+} // namespace
+
 ContentWrapper::ContentWrapper(ContentGroups& cgs) : m_contentGroups{cgs} {}
 
+ContentWrapper::ContentWrapper(ContentGroups& cgs, bool indexed) : m_contentGroups{cgs}
+{
+  if (indexed) {
+    reindex();
+  }
+}
+
 ContentWrapper::~ContentWrapper() {}
 
+void ContentWrapper::reindex()
+{
+  m_index.emplace();
+  m_index->items.resize(m_contentGroups.size());
+  indexGroupLabels();
+}
+
+const std::string& ContentWrapper::indexedGroupLabel(const LabelIndex::GroupEntry& entry) const
+{
+  return std::get<std::string>(m_contentGroups[entry.group][entry.item].value);
+}
+
+// Every group label item is indexed, not just the first of each group, so a lookup finds the
+// same group as the scan does.
+void ContentWrapper::indexGroupLabels()
+{
+  auto& groups = m_index->groups;
+  groups.clear();
+  groups.reserve(m_contentGroups.size());
+  for (size_t i = 0; i < m_contentGroups.size(); ++i) {
+    for (size_t j = 0; j < m_contentGroups[i].size(); ++j) {
+      const Content& content = m_contentGroups[i][j];
+      if (content.label == CONTENT_GROUP_LABEL) {
+        EOS_CHECK(std::holds_alternative<std::string>(content.value), "fatal error: " + CONTENT_GROUP_LABEL + " must be a string");
+        groups.push_back({labelHash(std::get<std::string>(content.value)), uint32_t(i), uint32_t(j)});
+      }
+    }
+  }
+  std::sort(groups.begin(), groups.end());
+}
+
+// Sorting the items is most of the cost of the index, so a group waits until it is searched.
+// A sorted run has an entry for every item of the group.
+void ContentWrapper::indexItems(size_t groupIndex)
+{
+  const ContentGroup& contentGroup = m_contentGroups[groupIndex];
+  auto& items = m_index->items[groupIndex];
+  if (items.size() == contentGroup.size()) {
+    return;
+  }
+
+  items.resize(contentGroup.size());
+  for (size_t i = 0; i < contentGroup.size(); ++i) {
+    items[i] = {labelHash(contentGroup[i].label), i};
+  }
+  std::sort(items.begin(), items.end());
+}
+
 std::pair<int64_t, ContentGroup *> ContentWrapper::getGroup(const std::string &label)
 {
+    if (m_index)
+    {
+        const auto &groups = m_index->groups;
+        const uint64_t hash = labelHash(label);
+        for (auto itr = std::lower_bound(groups.begin(), groups.end(), LabelIndex::GroupEntry{hash, 0, 0});
+             itr != groups.end() && itr->hash == hash; ++itr)
+        {
+            if (indexedGroupLabel(*itr) == label)
+            {
+                return {(int64_t)itr->group, &getContentGroups()[itr->group]};
+            }
+        }
+        return {-1, nullptr};
+    }
+
     for (std::size_t i = 0; i < getContentGroups().size(); ++i)
     {
         for (Content &content : getContentGroups()[i])
@@ -45,6 +135,13 @@ std::pair<int64_t, ContentGroup*> ContentWrapper::getGroupOrCreate(const string&
     }));
 
     contentGroup = &m_contentGroups[idx];
+
+    if (m_index) {
+      LabelIndex::GroupEntry entry{labelHash(label), uint32_t(idx), 0};
+      auto& groups = m_index->groups;
+      groups.insert(std::lower_bound(groups.begin(), groups.end(), entry), entry);
+      m_index->items.push_back({{labelHash(CONTENT_GROUP_LABEL), 0}});
+    }
   }
 
   return { idx, contentGroup };
@@ -64,7 +161,9 @@ ContentGroup *ContentWrapper::getGroupOrFail(const std::string &label, const std
 ContentGroup *ContentWrapper::getGroupOrFail(const std::string &groupLabel)
 {
     TRACE_FUNCTION()
-    return getGroupOrFail(groupLabel, "group: " + groupLabel + " is required but not found");
+    auto [idx, contentGroup] = getGroup(groupLabel);
+    EOS_CHECK(idx != -1, "group: " + groupLabel + " is required but not found");
+    return contentGroup;
 }
 
 std::pair<int64_t, Content *> ContentWrapper::get(const std::string &groupLabel, const std::string &contentLabel)
@@ -89,8 +188,10 @@ Content *ContentWrapper::getOrFail(const std::string &groupLabel, const std::str
 Content *ContentWrapper::getOrFail(const std::string &groupLabel, const std::string &contentLabel)
 {
     TRACE_FUNCTION()
-    return getOrFail(groupLabel, contentLabel, "group: " + groupLabel + "; content: " + contentLabel + 
+    auto [idx, item] = get(groupLabel, contentLabel);
+    EOS_CHECK(idx != -1, "group: " + groupLabel + "; content: " + contentLabel + 
         " is required but not found");
+    return item;
 }
 
 std::pair<int64_t, Content*> ContentWrapper::getOrFail(size_t groupIndex, const std::string &contentLabel, string_view error)
@@ -127,6 +228,11 @@ std::pair<int64_t, Content *> ContentWrapper::get(size_t groupIndex, const std::
 
     auto& contentGroup = m_contentGroups[groupIndex];
 
+    if (m_index) {
+      const int64_t idx = indexedItem(groupIndex, contentLabel);
+      return {idx, idx == -1 ? nullptr : &contentGroup[idx]};
+    }
+
     for (size_t i = 0; i < contentGroup.size(); ++i)
     {
         if (contentGroup.at(i).label == contentLabel)
@@ -139,6 +245,75 @@ std::pair<int64_t, Content *> ContentWrapper::get(size_t groupIndex, const std::
   return {-1, nullptr};
 }
 
+int64_t ContentWrapper::indexedItem(size_t groupIndex, string_view contentLabel)
+{
+  indexItems(groupIndex);
+  const ContentGroup& contentGroup = m_contentGroups[groupIndex];
+  const auto& items = m_index->items[groupIndex];
+  const uint64_t hash = labelHash(contentLabel);
+  for (auto itr = std::lower_bound(items.begin(), items.end(), std::pair<uint64_t, uint32_t>(hash, 0));
+       itr != items.end() && itr->first == hash; ++itr) {
+    if (contentGroup[itr->second].label == contentLabel) {
+      return itr->second;
+    }
+  }
+  return -1;
+}
+
+// Each item is compared with the labels still unmatched, so the group is read once however
+// many labels are asked for.
+bool ContentWrapper::getFields(const std::string &groupLabel, const string_view *labels, Content **fields, size_t count)
+{
+  std::fill(fields, fields + count, nullptr);
+  auto [gidx, contentGroup] = getGroup(groupLabel);
+  if (!contentGroup) {
+    return false;
+  }
+
+  if (m_index) {
+    for (size_t i = 0; i < count; ++i) {
+      const int64_t idx = indexedItem(gidx, labels[i]);
+      fields[i] = idx == -1 ? nullptr : &(*contentGroup)[idx];
+    }
+    return true;
+  }
+
+  size_t remaining = count;
+  for (Content& content : *contentGroup) {
+    for (size_t i = 0; i < count; ++i) {
+      if (!fields[i] && content.label == labels[i]) {
+        fields[i] = &content;
+        if (--remaining == 0) {
+          return true;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void ContentWrapper::failItems(const std::string &context, const string_view *groups, const string_view *labels,
+                               const bool *found, const bool *valid, size_t count)
+{
+  string missing;
+  string mistyped;
+  for (size_t i = 0; i < count; ++i) {
+    if (valid[i]) {
+      continue;
+    }
+    string& list = found[i] ? mistyped : missing;
+    list += list.empty() ? "" : ", ";
+    if (groups) {
+      list.append(groups[i]).append("/");
+    }
+    list.append(labels[i]);
+  }
+
+  EOS_CHECK(false, context +
+                   (missing.empty() ? "" : "; content: " + missing + " is required but not found") +
+                   (mistyped.empty() ? "" : "; content: " + mistyped + " is not of expected type"));
+}
+
 void ContentWrapper::removeGroup(const std::string &groupLabel)
 {
   TRACE_FUNCTION()
@@ -154,6 +329,21 @@ void ContentWrapper::removeGroup(size_t groupIndex)
         "Can't remove invalid group index: " + std::to_string(groupIndex));
   
   m_contentGroups.erase(m_contentGroups.begin() + groupIndex);
+
+  if (m_index) {
+    // dropping the group's entries and shifting later groups down keeps the order
+    m_index->items.erase(m_index->items.begin() + groupIndex);
+
+    auto& groups = m_index->groups;
+    groups.erase(std::remove_if(groups.begin(), groups.end(), [&](const auto& entry) {
+      return entry.group == groupIndex;
+    }), groups.end());
+    for (auto& entry : groups) {
+      if (entry.group > groupIndex) {
+        entry.group--;
+      }
+    }
+  }
 }
 
 void ContentWrapper::removeContent(const std::string& groupLabel, const Content& content) 
@@ -211,6 +401,32 @@ void ContentWrapper::removeContent(size_t groupIndex, size_t contentIndex)
         "Can't remove invalid content index [Out Of Rrange]: " + std::to_string(contentIndex));
 
   contentGroup.erase(contentGroup.begin() + contentIndex);
+
+  if (m_index) {
+    // the same for the items of the group, and for the group labels among them
+    // a run that is not sorted yet is left empty
+    auto& items = m_index->items[groupIndex];
+    if (items.size() == contentGroup.size() + 1) {
+      items.erase(std::find_if(items.begin(), items.end(), [&](const auto& item) {
+        return item.second == contentIndex;
+      }));
+      for (auto& item : items) {
+        if (item.second > contentIndex) {
+          item.second--;
+        }
+      }
+    }
+
+    auto& groups = m_index->groups;
+    groups.erase(std::remove_if(groups.begin(), groups.end(), [&](const auto& entry) {
+      return entry.group == groupIndex && entry.item == contentIndex;
+    }), groups.end());
+    for (auto& entry : groups) {
+      if (entry.group == groupIndex && entry.item > contentIndex) {
+        entry.item--;
+      }
+    }
+  }
 }
 
 
@@ -221,7 +437,25 @@ void ContentWrapper::insertOrReplace(size_t groupIndex, const Content &newConten
   
   auto& contentGroup = m_contentGroups[groupIndex];
 
-  insertOrReplace(contentGroup, newContent);
+  if (!m_index) {
+    insertOrReplace(contentGroup, newContent);
+    return;
+  }
+
+  if (auto [idx, content] = get(groupIndex, newContent.label); content) {
+    content->value = newContent.value;
+  }
+  else {
+    // the new item comes last, so it goes after any other item with its hash
+    auto& items = m_index->items[groupIndex];
+    const std::pair<uint64_t, uint32_t> item(labelHash(newContent.label), contentGroup.size());
+    items.insert(std::lower_bound(items.begin(), items.end(), item), item);
+    contentGroup.push_back(Content{newContent.label, newContent.value});
+  }
+
+  if (newContent.label == CONTENT_GROUP_LABEL) {
+    indexGroupLabels();
+  }
 }
 
 string_view ContentWrapper::getGroupLabel(size_t groupIndex)
@@ -1,10 +1,12 @@
 #include <eosio/crypto.hpp>
 
-#include <map>
+#include <algorithm>
+#include <cstring>
 
 #include <logger/logger.hpp>
 
 #include <document_graph/document.hpp>
+#include <document_graph/state_cache.hpp>
 #include <document_graph/util.hpp>
 
 namespace hypha
@@ -34,19 +36,29 @@ namespace hypha
     {
     }
 
-    Document::Document(eosio::name contract, const eosio::checksum256 &_hash) : contract{contract}
+    Document::Document(eosio::name contract, const eosio::checksum256 &_hash, LoadMode mode) : contract{contract}
     {
         TRACE_FUNCTION()
         document_table d_t(contract, contract.value);
-        auto hash_index = d_t.get_index<eosio::name("idhash")>();
-        auto h_itr = hash_index.find(_hash);
-        EOS_CHECK(h_itr != hash_index.end(), "document not found: " + readableHash(_hash));
+        auto h_itr = findByHash(d_t, _hash);
+        EOS_CHECK(h_itr != d_t.end(), "document not found: " + readableHash(_hash));
 
         id = h_itr->id;
         creator = h_itr->creator;
         created_date = h_itr->created_date;
         certificates = h_itr->certificates;
-        content_groups = h_itr->content_groups;
+        content_groups = h_itr->readContentGroups();
+        group_keys = h_itr->group_keys;
+        hash_version = h_itr->hash_version;
+        group_hashes = h_itr->group_hashes;
+
+        if (mode == LoadMode::Trusted)
+        {
+            hash = h_itr->hash;
+            hashCurrent = true;
+            return;
+        }
+
         hashContents();
 
         // this should never happen, only if hash algorithm somehow changed
@@ -55,58 +67,115 @@ namespace hypha
 
     bool Document::exists(eosio::name contract, const eosio::checksum256 &_hash)
     {
-        document_table d_t(contract, contract.value);
-        auto hash_index = d_t.get_index<eosio::name("idhash")>();
-        auto h_itr = hash_index.find(_hash);
-
-        if (h_itr != hash_index.end())
+        if (getHeaderState(contract).complete)
         {
-            return true;
+            return getHeader(contract, _hash).has_value();
         }
-        return false;
+
+        document_table d_t(contract, contract.value);
+        return findByHash(d_t, _hash) != d_t.end();
     }
 
     void Document::emplace()
+    {
+        emplace(std::vector<uint64_t>{});
+    }
+
+    void Document::emplace(const std::vector<uint64_t> &releasedGroupKeys)
     {
         TRACE_FUNCTION()
-        hashContents();
+        // a hash carried over from merge or getOrNew is reused when its version is still current
+        std::uint8_t hashVersion = getHashState(getContract()).hash_version;
+        if (!hashCurrent || getHashVersion() != hashVersion)
+        {
+            setHashVersion(hashVersion);
+            hashContents();
+        }
 
         document_table d_t(getContract(), getContract().value);
-        auto hash_index = d_t.get_index<eosio::name("idhash")>();
-        auto h_itr = hash_index.find(hash);
 
         // if this content exists already, error out and send back the hash of the existing document
-        EOS_CHECK(h_itr == hash_index.end(), "document exists already: " + readableHash(hash));
+        EOS_CHECK(findByHash(d_t, hash) == d_t.end(), "document exists already: " + readableHash(hash));
+
+        if (getStorageState(getContract()).group_storage)
+        {
+            group_keys.emplace(storeGroups(getContract(), content_groups, releasedGroupKeys));
+        }
+        else if (hash_version.has_value())
+        {
+            group_keys.emplace();
+        }
+        else
+        {
+            group_keys.reset();
+        }
 
+        id = nextPrimaryKey(d_t, hash);
         d_t.emplace(getContract(), [&](auto &d) {
-            id = d_t.available_primary_key();
             created_date = eosio::current_time_point();
             d = *this;
+            if (!getGroupKeys().empty())
+            {
+                d.content_groups.clear();
+            }
         });
+        writeHeader(*this);
+    }
+
+    Document Document::emplaceRevision(const Document &previous, eosio::name creator, ContentGroups contentGroups)
+    {
+        Document document{};
+        document.contract = previous.getContract();
+        document.creator = creator;
+        document.content_groups = std::move(contentGroups);
+        document.emplace(previous.getGroupKeys());
+        return document;
+    }
+
+    Document Document::emplaceMerge(const Document &previous, eosio::name creator, const Document &deltas)
+    {
+        Document document{};
+        document.contract = previous.getContract();
+        document.creator = creator;
+        document.content_groups = previous.content_groups;
+        // with the hash state of previous, merge keeps the hashes of the untouched groups
+        document.hash = previous.hash;
+        document.hash_version = previous.hash_version;
+        document.group_hashes = previous.group_hashes;
+        document.hashCurrent = previous.hashCurrent;
+
+        MergeChanges changes = mergeInPlace(document, deltas);
+        EOS_CHECK(changes.changed(), "deltas do not change document: " + readableHash(previous.getHash()));
+        document.emplace(previous.getGroupKeys());
+        return document;
     }
 
     Document Document::getOrNew(eosio::name _contract, eosio::name _creator, ContentGroups contentGroups)
     {
         Document document{};
+        document.contract = _contract;
         document.content_groups = contentGroups;
+        document.setHashVersion(getHashState(_contract).hash_version);
         document.hashContents();
 
         Document::document_table d_t(_contract, _contract.value);
-        auto hash_index = d_t.get_index<eosio::name("idhash")>();
-        auto h_itr = hash_index.find(document.hash);
+        auto h_itr = findByHash(d_t, document.hash);
 
         // if this content exists already, return this one
-        if (h_itr != hash_index.end())
+        if (h_itr != d_t.end())
         {
-            document.contract = _contract;
             document.creator = h_itr->creator;
             document.created_date = h_itr->created_date;
             document.certificates = h_itr->certificates;
             document.id = h_itr->id;
+            document.group_keys = h_itr->group_keys;
             return document;
         }
 
-        return Document(_contract, _creator, contentGroups);
+        // emplace keeps the hash computed above
+        document.creator = _creator;
+        document.emplace();
+        return document;
     }
 
     Document Document::getOrNew(eosio::name contract, eosio::name creator, ContentGroup contentGroup)
@@ -124,6 +193,417 @@ namespace hypha
         return getOrNew(contract, creator, rollup(Content(label, value)));
     }
 
+    namespace
+    {
+        // shared by the document and header tables, which use the same primary keys
+        template <typename Table>
+        typename Table::const_iterator findRow(const Table &table, const eosio::checksum256 &hash)
+        {
+            const DocumentKeyState &state = Document::getKeyState(table.get_code());
+            if (state.key_version == 2)
+            {
+                // the first empty key ends the probe sequence, see Document::eraseRow
+                uint64_t key = Document::hashKey(hash);
+                for (uint64_t probe = 0; probe < Document::MAX_KEY_PROBES; ++probe, ++key)
+                {
+                    auto itr = table.find(key);
+                    if (itr == table.end())
+                    {
+                        break;
+                    }
+                    if (itr->by_hash() == hash)
+                    {
+                        return itr;
+                    }
+                }
+
+                if (!state.migrating)
+                {
+                    return table.end();
+                }
+            }
+
+            auto hash_index = table.template get_index<eosio::name("idhash")>();
+            auto h_itr = hash_index.find(hash);
+            if (h_itr == hash_index.end())
+            {
+                return table.end();
+            }
+            return table.iterator_to(*h_itr);
+        }
+    } // namespace
+
+    const DocumentKeyState &Document::getKeyState(const eosio::name &contract)
+    {
+        return getCachedState<document_key_singleton, DocumentKeyState>(contract);
+    }
+
+    void Document::setKeyState(const eosio::name &contract, const DocumentKeyState &state)
+    {
+        setCachedState<document_key_singleton>(contract, state);
+    }
+
+    const DocumentHeaderState &Document::getHeaderState(const eosio::name &contract)
+    {
+        return getCachedState<header_state_singleton, DocumentHeaderState>(contract);
+    }
+
+    void Document::setHeaderState(const eosio::name &contract, const DocumentHeaderState &state)
+    {
+        setCachedState<header_state_singleton>(contract, state);
+    }
+
+    const DocumentStorageState &Document::getStorageState(const eosio::name &contract)
+    {
+        return getCachedState<storage_state_singleton, DocumentStorageState>(contract);
+    }
+
+    void Document::setStorageState(const eosio::name &contract, const DocumentStorageState &state)
+    {
+        setCachedState<storage_state_singleton>(contract, state);
+    }
+
+    ContentGroups Document::readContentGroups() const
+    {
+        if (!hasStoredGroups())
+        {
+            return content_groups;
+        }
+
+        DocumentGroup::group_table g_t(contract, contract.value);
+        ContentGroups contentGroups;
+        contentGroups.reserve(group_keys.value().size());
+        for (uint64_t key : group_keys.value())
+        {
+            contentGroups.push_back(g_t.get(key, "document group not found").content_group);
+        }
+        return contentGroups;
+    }
+
+    eosio::checksum256 Document::hashGroup(const ContentGroup &contentGroup)
+    {
+        std::string string_data(canonicalSize(contentGroup), '\0');
+        writeCanonical(contentGroup, string_data.data());
+        return eosio::sha256(string_data.data(), string_data.length());
+    }
+
+    std::vector<eosio::checksum256> Document::hashGroups(const ContentGroups &contentGroups)
+    {
+        std::vector<eosio::checksum256> groupHashes;
+        groupHashes.reserve(contentGroups.size());
+        for (const ContentGroup &contentGroup : contentGroups)
+        {
+            groupHashes.push_back(hashGroup(contentGroup));
+        }
+        return groupHashes;
+    }
+
+    eosio::checksum256 Document::hashGroupTree(std::vector<eosio::checksum256> groupHashes)
+    {
+        constexpr std::size_t HASH_SIZE = 32;
+        char node[1 + 2 * HASH_SIZE];
+        node[0] = 0x01;
+
+        // hashes each level in place until one node is left
+        while (groupHashes.size() > 1)
+        {
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < groupHashes.size(); i += 2)
+            {
+                if (i + 1 == groupHashes.size())
+                {
+                    groupHashes[next++] = groupHashes[i];
+                    continue;
+                }
+
+                auto left = groupHashes[i].extract_as_byte_array();
+                auto right = groupHashes[i + 1].extract_as_byte_array();
+                std::memcpy(node + 1, left.data(), HASH_SIZE);
+                std::memcpy(node + 1 + HASH_SIZE, right.data(), HASH_SIZE);
+                groupHashes[next++] = eosio::sha256(node, sizeof(node));
+            }
+            groupHashes.resize(next);
+        }
+
+        // the version byte keeps version 2 hashes apart from version 1 and group hashes, which
+        // start with '['; a document without groups hashes the version byte alone
+        char root[1 + HASH_SIZE] = {0x02};
+        if (groupHashes.empty())
+        {
+            return eosio::sha256(root, 1);
+        }
+
+        auto bytes = groupHashes.front().extract_as_byte_array();
+        std::memcpy(root + 1, bytes.data(), HASH_SIZE);
+        return eosio::sha256(root, sizeof(root));
+    }
+
+    const DocumentHashState &Document::getHashState(const eosio::name &contract)
+    {
+        return getCachedState<hash_state_singleton, DocumentHashState>(contract);
+    }
+
+    void Document::setHashState(const eosio::name &contract, const DocumentHashState &state)
+    {
+        setCachedState<hash_state_singleton>(contract, state);
+    }
+
+    void Document::setHashVersion(std::uint8_t hashVersion)
+    {
+        EOS_CHECK(hashVersion == 1 || hashVersion == 2, "unknown document hash version: " + std::to_string(hashVersion));
+        hashCurrent = false;
+        if (hashVersion == 1)
+        {
+            hash_version.reset();
+            group_hashes.reset();
+            return;
+        }
+        hash_version.emplace(hashVersion);
+    }
+
+    bool Document::hasValidHash() const
+    {
+        ContentGroups contentGroups = readContentGroups();
+        if (getHashVersion() == 1)
+        {
+            return hashContents(contentGroups) == hash;
+        }
+
+        std::vector<eosio::checksum256> groupHashes = hashGroups(contentGroups);
+        return groupHashes == getGroupHashes() && hashGroupTree(groupHashes) == hash;
+    }
+
+    std::vector<uint64_t> Document::storeGroups(const eosio::name &contract, const ContentGroups &contentGroups,
+                                                std::vector<uint64_t> releasedGroupKeys)
+    {
+        TRACE_FUNCTION()
+        DocumentGroup::group_table g_t(contract, contract.value);
+        auto hash_index = g_t.get_index<eosio::name("idhash")>();
+
+        std::vector<uint64_t> keys;
+        keys.reserve(contentGroups.size());
+        for (const ContentGroup &contentGroup : contentGroups)
+        {
+            eosio::checksum256 groupHash = hashGroup(contentGroup);
+            auto g_itr = hash_index.find(groupHash);
+            if (g_itr == hash_index.end())
+            {
+                uint64_t key = g_t.available_primary_key();
+                g_t.emplace(contract, [&](auto &g) {
+                    g.id = key;
+                    g.hash = groupHash;
+                    g.references = 1;
+                    g.content_group = contentGroup;
+                });
+                keys.push_back(key);
+                continue;
+            }
+
+            // a group taken over from the released document keeps its reference as is
+            auto released = std::find(releasedGroupKeys.begin(), releasedGroupKeys.end(), g_itr->id);
+            if (released != releasedGroupKeys.end())
+            {
+                releasedGroupKeys.erase(released);
+            }
+            else
+            {
+                hash_index.modify(g_itr, contract, [&](auto &g) {
+                    g.references++;
+                });
+            }
+            keys.push_back(g_itr->id);
+        }
+        return keys;
+    }
+
+    void Document::releaseGroups(const eosio::name &contract, const std::vector<uint64_t> &groupKeys,
+                                 std::vector<uint64_t> keptGroupKeys)
+    {
+        TRACE_FUNCTION()
+        DocumentGroup::group_table g_t(contract, contract.value);
+        for (uint64_t key : groupKeys)
+        {
+            auto kept = std::find(keptGroupKeys.begin(), keptGroupKeys.end(), key);
+            if (kept != keptGroupKeys.end())
+            {
+                keptGroupKeys.erase(kept);
+                continue;
+            }
+
+            auto g_itr = g_t.find(key);
+            EOS_CHECK(g_itr != g_t.end(), "document group not found: " + std::to_string(key));
+            if (g_itr->references > 1)
+            {
+                g_t.modify(g_itr, contract, [&](auto &g) {
+                    g.references--;
+                });
+            }
+            else
+            {
+                g_t.erase(g_itr);
+            }
+        }
+    }
+
+    DocumentHeader Document::getHeader() const
+    {
+        ContentGroups storedGroups;
+        const ContentGroups &contentGroups = hasStoredGroups() ? (storedGroups = readContentGroups()) : content_groups;
+
+        DocumentHeader header;
+        header.id = id;
+        header.hash = hash;
+        header.creator = creator;
+        header.body_size = eosio::pack_size(contentGroups);
+        header.created_date = created_date;
+
+        for (const ContentGroup &contentGroup : contentGroups)
+        {
+            for (const Content &content : contentGroup)
+            {
+                if (content.label == "type" && std::holds_alternative<eosio::name>(content.value))
+                {
+                    header.type = std::get<eosio::name>(content.value);
+                    return header;
+                }
+            }
+        }
+        return header;
+    }
+
+    std::optional<DocumentHeader> Document::getHeader(const eosio::name &contract, const eosio::checksum256 &_hash)
+    {
+        if (!getHeaderState(contract).complete)
+        {
+            document_table d_t(contract, contract.value);
+            auto itr = findByHash(d_t, _hash);
+            if (itr == d_t.end())
+            {
+                return std::nullopt;
+            }
+            return itr->getHeader();
+        }
+
+        DocumentHeader::header_table h_t(contract, contract.value);
+        auto itr = findRow(h_t, _hash);
+        if (itr == h_t.end())
+        {
+            return std::nullopt;
+        }
+        return *itr;
+    }
+
+    void Document::writeHeader(const Document &document)
+    {
+        const eosio::name &contract = document.getContract();
+        if (!getHeaderState(contract).enabled())
+        {
+            return;
+        }
+
+        DocumentHeader::header_table h_t(contract, contract.value);
+        h_t.emplace(contract, [&](auto &h) {
+            h = document.getHeader();
+        });
+    }
+
+    void Document::eraseHeader(const eosio::name &contract, uint64_t key)
+    {
+        if (!getHeaderState(contract).enabled())
+        {
+            return;
+        }
+
+        // rows written before the header migration may not have one yet
+        DocumentHeader::header_table h_t(contract, contract.value);
+        auto itr = h_t.find(key);
+        if (itr != h_t.end())
+        {
+            h_t.erase(itr);
+        }
+    }
+
+    uint64_t Document::hashKey(const eosio::checksum256 &hash)
+    {
+        auto hbytes = hash.extract_as_byte_array();
+        uint64_t key = 0;
+        for (std::size_t i = 0; i < sizeof(key); ++i)
+        {
+            key <<= 8;
+            key |= hbytes[i];
+        }
+        return key;
+    }
+
+    Document::document_table::const_iterator Document::findByHash(const document_table &d_t, const eosio::checksum256 &_hash)
+    {
+        return findRow(d_t, _hash);
+    }
+
+    uint64_t Document::nextPrimaryKey(const document_table &d_t, const eosio::checksum256 &_hash)
+    {
+        if (getKeyState(d_t.get_code()).key_version != 2)
+        {
+            return d_t.available_primary_key();
+        }
+
+        uint64_t key = hashKey(_hash);
+        for (uint64_t probe = 0; probe < MAX_KEY_PROBES; ++probe, ++key)
+        {
+            if (d_t.find(key) == d_t.end())
+            {
+                return key;
+            }
+        }
+
+        EOS_CHECK(false, "no free primary key for document: " + readableHash(_hash));
+        return 0;
+    }
+
+    void Document::emplaceAt(document_table &d_t, const Document &document, uint64_t key)
+    {
+        auto itr = d_t.emplace(d_t.get_code(), [&](auto &d) {
+            d = document;
+            d.id = key;
+        });
+        writeHeader(*itr);
+    }
+
+    void Document::eraseRow(document_table &d_t, document_table::const_iterator itr)
+    {
+        uint64_t hole = itr->primary_key();
+        d_t.erase(itr);
+        eraseHeader(d_t.get_code(), hole);
+
+        if (getKeyState(d_t.get_code()).key_version != 2)
+        {
+            return;
+        }
+
+        // shift later rows of the probe sequence back into the hole, as in linear probing. The
+        // run ends at the first empty key; the hole moves with each shifted row, and a row
+        // MAX_KEY_PROBES or more past the current hole can neither move into it nor be cut off by it
+        for (uint64_t key = hole + 1; key - hole < MAX_KEY_PROBES; ++key)
+        {
+            auto next = d_t.find(key);
+            if (next == d_t.end())
+            {
+                break;
+            }
+
+            // distances are modular; rows outside their probe range are legacy ids and stay put
+            uint64_t displacement = key - hashKey(next->hash);
+            if (displacement < MAX_KEY_PROBES && displacement >= key - hole)
+            {
+                Document moved = *next;
+                d_t.erase(next);
+                eraseHeader(d_t.get_code(), key);
+                emplaceAt(d_t, moved, hole);
+                hole = key;
+            }
+        }
+    }
+
     // void Document::certify(const eosio::name &certifier, const std::string &notes)
     // {
     //     // check if document is already saved??
@@ -143,7 +623,16 @@ namespace hypha
     const void Document::hashContents()
     {
         // save/cache the hash in the member
-        hash = hashContents(content_groups);
+        if (getHashVersion() == 2)
+        {
+            group_hashes.emplace(hashGroups(content_groups));
+            hash = hashGroupTree(group_hashes.value());
+        }
+        else
+        {
+            hash = hashContents(content_groups);
+        }
+        hashCurrent = true;
     }
 
     const std::string Document::toString()
@@ -154,13 +643,65 @@ namespace hypha
     // static version cannot cache the hash in a member
     const eosio::checksum256 Document::hashContents(const ContentGroups &contentGroups)
     {
-        std::string string_data = toString(contentGroups);
-        return eosio::sha256(const_cast<char *>(string_data.c_str()), string_data.length());
+        // encode into a single pre-sized buffer; same bytes as toString(contentGroups)
+        std::string string_data(canonicalSize(contentGroups), '\0');
+        writeCanonical(contentGroups, string_data.data());
+        return eosio::sha256(string_data.data(), string_data.length());
+    }
+
+    const eosio::checksum256 Document::hashContents(const ContentGroups &contentGroups, std::uint8_t hashVersion)
+    {
+        if (hashVersion == 2)
+        {
+            return hashGroupTree(hashGroups(contentGroups));
+        }
+        return hashContents(contentGroups);
+    }
+
+    const eosio::checksum256 Document::hashContents(const eosio::name &contract, const ContentGroups &contentGroups)
+    {
+        return hashContents(contentGroups, getHashState(contract).hash_version);
     }
 
     const std::string Document::toString(const ContentGroups &contentGroups)
     {
-        std::string results = "[";
+        std::string results(canonicalSize(contentGroups), '\0');
+        writeCanonical(contentGroups, results.data());
+        return results;
+    }
+
+    const std::string Document::toString(const ContentGroup &contentGroup)
+    {
+        std::string results(canonicalSize(contentGroup), '\0');
+        writeCanonical(contentGroup, results.data());
+        return results;
+    }
+
+    // [group,group,...]
+    std::size_t Document::canonicalSize(const ContentGroups &contentGroups)
+    {
+        std::size_t size = 2 + (contentGroups.empty() ? 0 : contentGroups.size() - 1);
+        for (const ContentGroup &contentGroup : contentGroups)
+        {
+            size += canonicalSize(contentGroup);
+        }
+        return size;
+    }
+
+    // [content,content,...]; empty content still takes its separator
+    std::size_t Document::canonicalSize(const ContentGroup &contentGroup)
+    {
+        std::size_t size = 2 + (contentGroup.empty() ? 0 : contentGroup.size() - 1);
+        for (const Content &content : contentGroup)
+        {
+            size += content.canonicalSize();
+        }
+        return size;
+    }
+
+    char *Document::writeCanonical(const ContentGroups &contentGroups, char *out)
+    {
+        *out++ = '[';
         bool is_first = true;
 
         for (const ContentGroup &contentGroup : contentGroups)
@@ -171,18 +712,18 @@ namespace hypha
             }
             else
             {
-                results = results + ",";
+                *out++ = ',';
             }
-            results = results + toString(contentGroup);
+            out = writeCanonical(contentGroup, out);
         }
 
-        results = results + "]";
-        return results;
+        *out++ = ']';
+        return out;
     }
 
-    const std::string Document::toString(const ContentGroup &contentGroup)
+    char *Document::writeCanonical(const ContentGroup &contentGroup, char *out)
     {
-        std::string results = "[";
+        *out++ = '[';
         bool is_first = true;
 
         for (const Content &content : contentGroup)
@@ -193,13 +734,13 @@ namespace hypha
             }
             else
             {
-                results = results + ",";
+                *out++ = ',';
             }
-            results = results + content.toString();
+            out = content.writeCanonical(out);
         }
 
-        results = results + "]";
-        return results;
+        *out++ = ']';
+        return out;
     }
 
     ContentGroups Document::rollup(ContentGroup contentGroup)
@@ -274,72 +815,302 @@ namespace hypha
     * }
     */
     Document Document::merge(Document original, Document &deltas)
+    {
+      mergeInPlace(original, deltas);
+      return original;
+    }
+
+    bool MergeChanges::changed() const
+    {
+      return removed != 0 || std::find(sources.begin(), sources.end(), CHANGED) != sources.end();
+    }
+
+    MergeChanges Document::mergeInPlace(Document &original, const Document &deltas)
     {
       TRACE_FUNCTION()
-      const auto& deltasGroups = deltas.getContentGroups();
-      auto& originalGroups = original.getContentGroups();
-      auto deltasWrapper = deltas.getContentWrapper();
-      auto originalWrapper = original.getContentWrapper();
+      //Internal marks, next to MergeChanges::CHANGED
+      constexpr uint32_t REMOVED = MergeChanges::CHANGED - 1;
+      constexpr uint32_t SKIPPED = MergeChanges::CHANGED - 2;
+
+      auto& originalGroups = original.content_groups;
+      const auto& deltasGroups = deltas.content_groups;
+      const size_t originalSize = originalGroups.size();
 
-      //unordered_map not available with eosio atm
-      std::map<string, std::pair<size_t, ContentGroup*>> groupsByLabel;
+      //With version 2 hashes, the hashes of groups the deltas leave alone are kept
+      const bool keepHashes = original.getHashVersion() == 2 && original.hashCurrent &&
+                              original.group_hashes.value().size() == originalSize;
+      original.hashCurrent = false;
 
-      for (size_t i = 0; i < originalGroups.size(); ++i) {
+      MergeChanges changes;
+      changes.sources.reserve(originalSize + deltasGroups.size());
+      for (size_t i = 0; i < originalSize; ++i) {
+        changes.sources.push_back(static_cast<uint32_t>(i));
+      }
+
+      //Labels of the original groups, sorted; the views stay valid because the
+      //groups are not touched until every delta group has found its target
+      std::vector<std::pair<string_view, uint32_t>> labels;
+      labels.reserve(originalSize);
+      for (size_t i = 0; i < originalSize; ++i) {
         auto label = ContentWrapper::getGroupLabel(originalGroups[i]);
         if (!label.empty()) {
-          groupsByLabel[string(label)] = std::pair{i, &originalGroups[i]};
+          labels.emplace_back(label, static_cast<uint32_t>(i));
+        }
+      }
+      std::sort(labels.begin(), labels.end());
+
+      //First group with the label that is not deleted, as ContentWrapper::getGroup would find
+      auto findGroup = [&](string_view label) -> int64_t {
+        for (auto it = std::lower_bound(labels.begin(), labels.end(), std::pair{label, uint32_t(0)});
+             it != labels.end() && it->first == label; ++it) {
+          if (changes.sources[it->second] != REMOVED) {
+            return it->second;
+          }
         }
-      }  
+        return -1;
+      };
 
+      //Resolve every delta group first: the original group it updates, or whether it
+      //is appended or only deletes; deletions are marked and compacted at the end
+      std::vector<uint32_t> targets(deltasGroups.size(), SKIPPED);
       for (size_t i = 0; i < deltasGroups.size(); ++i) {
-        
+
         auto label = ContentWrapper::getGroupLabel(deltasGroups[i]);
-                
+
         //If there is no group label just append it to the original doc
         if (label.empty()) {
-          originalGroups.push_back(deltasGroups[i]);
+          targets[i] = MergeChanges::CHANGED;
           continue;
         }
-        
+
+        bool deleteGroup = false;
+        bool skipFromMerge = false;
+        for (const auto& content : deltasGroups[i]) {
+          deleteGroup |= content.label == "delete_group";
+          skipFromMerge |= content.label == "skip_from_merge";
+        }
+
         //Check if we need to delete the group
-        if (auto [idx, c] = deltasWrapper.get(i, "delete_group"); 
-            c) {
-          originalWrapper.removeGroup(string(label));
+        if (deleteGroup) {
+          auto groupIdx = findGroup(label);
+          EOS_CHECK(groupIdx != -1,
+                "Can't remove unexisting group: " + string(label));
+          changes.sources[groupIdx] = REMOVED;
+          changes.removed++;
           continue;
         }
 
         //Check if we need to skip this group from merge
-        if (auto [_, c] = deltasWrapper.get(i, "skip_from_merge"); 
-            c) {
+        if (skipFromMerge) {
           continue;
         }
-        
+
         //If group is not present on original document we should append it
-        if (auto groupIt = groupsByLabel.find(string(label)); 
-            groupIt == groupsByLabel.end()) {
+        auto groupIdx = findGroup(label);
+        targets[i] = groupIdx == -1 ? MergeChanges::CHANGED : static_cast<uint32_t>(groupIdx);
+      }
+
+      for (size_t i = 0; i < deltasGroups.size(); ++i) {
+        const uint32_t target = targets[i];
+        if (target == SKIPPED) {
+          continue;
+        }
+
+        if (target == MergeChanges::CHANGED) {
           originalGroups.push_back(deltasGroups[i]);
+          changes.sources.push_back(MergeChanges::CHANGED);
+          continue;
         }
-        else {
-          auto [oriGroupIdx, oriGroup] = groupIt->second;
-
-          //It doesn't matter if it replaces content_group_label as they should be equal
-          for (auto& deltaContent : deltasGroups[i]) {
-            // Proposed fix is to use ballot_title & ballot_description as
-            // a separated item
-            // if (deltaContent.label == "title") {
-            //     // TODO: fix hack: we need to separate 'ballot title' from the assignment/document title
-            //     continue;
-            // }
-            if (std::holds_alternative<std::monostate>(deltaContent.value)) {
-              originalWrapper.removeContent(oriGroupIdx, deltaContent.label);
-            }
-            else {
-              originalWrapper.insertOrReplace(oriGroupIdx, deltaContent);
-            }
+
+        //A later delta group deleted it
+        if (changes.sources[target] == REMOVED) {
+          continue;
+        }
+        changes.sources[target] = MergeChanges::CHANGED;
+
+        //It doesn't matter if it replaces content_group_label as they should be equal
+        auto& group = originalGroups[target];
+        for (const auto& deltaContent : deltasGroups[i]) {
+          // Proposed fix is to use ballot_title & ballot_description as
+          // a separated item
+          // if (deltaContent.label == "title") {
+          //     // TODO: fix hack: we need to separate 'ballot title' from the assignment/document title
+          //     continue;
+          // }
+          if (std::holds_alternative<std::monostate>(deltaContent.value)) {
+            auto contentIt = std::find_if(group.begin(), group.end(), [&](const Content& c) {
+              return c.label == deltaContent.label;
+            });
+            EOS_CHECK(contentIt != group.end(),
+                  "Can't remove unexisting content [" + deltaContent.label + "]");
+            group.erase(contentIt);
+          }
+          else {
+            ContentWrapper::insertOrReplace(group, deltaContent);
           }
         }
       }
 
-      return original;
+      //One pass moves the kept groups down over the deleted ones
+      if (changes.removed) {
+        size_t kept = 0;
+        for (size_t i = 0; i < originalGroups.size(); ++i) {
+          if (changes.sources[i] == REMOVED) {
+            continue;
+          }
+          if (kept != i) {
+            originalGroups[kept] = std::move(originalGroups[i]);
+            changes.sources[kept] = changes.sources[i];
+          }
+          ++kept;
+        }
+        originalGroups.resize(kept);
+        changes.sources.resize(kept);
+      }
+
+      if (keepHashes) {
+        //A kept group only moves down, so its old hash is read before it is overwritten
+        auto& hashes = original.group_hashes.value();
+        if (hashes.size() < originalGroups.size()) {
+          hashes.resize(originalGroups.size());
+        }
+        for (size_t i = 0; i < originalGroups.size(); ++i) {
+          const uint32_t source = changes.sources[i];
+          hashes[i] = source == MergeChanges::CHANGED ? hashGroup(originalGroups[i]) : hashes[source];
+        }
+        hashes.resize(originalGroups.size());
+        original.hash = hashGroupTree(hashes);
+        original.hashCurrent = true;
+      }
+
+      return changes;
+    }
+
+    ContentGroups Document::diff(const ContentGroups &original, const ContentGroups &updated)
+    {
+      TRACE_FUNCTION()
+      auto sameContent = [](const Content& a, const Content& b) {
+        return a.label == b.label && a.value == b.value;
+      };
+      auto sameGroup = [&](const ContentGroup& a, const ContentGroup& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), sameContent);
+      };
+
+      //Labels of the groups, sorted as in mergeInPlace, so the groups sharing a label
+      //stay in order
+      using Labels = std::vector<std::pair<string_view, uint32_t>>;
+      auto sortLabels = [](const ContentGroups& groups) {
+        Labels labels;
+        labels.reserve(groups.size());
+        for (size_t i = 0; i < groups.size(); ++i) {
+          auto label = ContentWrapper::getGroupLabel(groups[i]);
+          if (!label.empty()) {
+            labels.emplace_back(label, static_cast<uint32_t>(i));
+          }
+        }
+        std::sort(labels.begin(), labels.end());
+        return labels;
+      };
+      auto withLabel = [](const Labels& labels, string_view label) {
+        return std::equal_range(labels.begin(), labels.end(), std::pair{label, uint32_t(0)},
+                                [](const auto& a, const auto& b) { return a.first < b.first; });
+      };
+      const Labels originalLabels = sortLabels(original);
+      const Labels updatedLabels = sortLabels(updated);
+
+      auto findLabel = [](const ContentGroup& contentGroup, const string& contentLabel) {
+        return std::find_if(contentGroup.begin(), contentGroup.end(), [&](const Content& c) {
+          return c.label == contentLabel;
+        });
+      };
+
+      ContentGroups deltas;
+      //Updated groups that merge derives from an original group
+      std::vector<bool> derived(updated.size(), false);
+      //Merge keeps the unlabeled groups of original as they are
+      size_t unlabeled = 0;
+
+      for (size_t i = 0; i < original.size(); ++i) {
+        auto label = ContentWrapper::getGroupLabel(original[i]);
+        if (label.empty()) {
+          unlabeled++;
+          continue;
+        }
+
+        //The groups sharing a label are handled at the first one
+        auto [first, last] = withLabel(originalLabels, label);
+        if (first->second != i) {
+          continue;
+        }
+        auto [updatedFirst, updatedLast] = withLabel(updatedLabels, label);
+        const size_t count = last - first;
+        const size_t updatedCount = updatedLast - updatedFirst;
+
+        //Merge only reaches the first group with the label that is not deleted, and appends
+        //a group only once none is left. So the surplus original groups are deleted from the
+        //front, the first one left is updated and the rest must be the same as their pairs;
+        //if they are not, all are deleted and the updated ones appended below
+        const size_t surplus = count - std::min(count, updatedCount);
+        bool inPlace = updatedCount <= count;
+        for (size_t k = 1; inPlace && k < updatedCount; ++k) {
+          inPlace = sameGroup(original[first[surplus + k].second], updated[updatedFirst[k].second]);
+        }
+
+        for (size_t k = 0; k < (inPlace ? surplus : count); ++k) {
+          deltas.push_back(ContentGroup{Content(CONTENT_GROUP_LABEL, string(label)), Content("delete_group", 1)});
+        }
+        if (!inPlace || updatedCount == 0) {
+          continue;
+        }
+        for (size_t k = 0; k < updatedCount; ++k) {
+          derived[updatedFirst[k].second] = true;
+        }
+
+        const auto& group = original[first[surplus].second];
+        const auto& updatedGroup = updated[updatedFirst->second];
+        ContentGroup delta;
+        for (const auto& content : updatedGroup) {
+          auto contentIt = findLabel(group, content.label);
+          if (contentIt == group.end() || !(contentIt->value == content.value)) {
+            delta.push_back(content);
+          }
+        }
+        for (const auto& content : group) {
+          if (findLabel(updatedGroup, content.label) == updatedGroup.end()) {
+            delta.push_back(Content(content.label, std::monostate{}));
+          }
+        }
+
+        //Merge finds the group by its label
+        if (!delta.empty()) {
+          delta.insert(delta.begin(), Content(CONTENT_GROUP_LABEL, string(label)));
+          deltas.push_back(std::move(delta));
+        }
+      }
+
+      //Everything else is appended, in order
+      for (size_t i = 0; i < updated.size(); ++i) {
+        if (derived[i]) {
+          continue;
+        }
+        if (unlabeled > 0 && ContentWrapper::getGroupLabel(updated[i]).empty()) {
+          unlabeled--;
+          continue;
+        }
+        deltas.push_back(updated[i]);
+      }
+
+      //Merge keeps the order of the original groups and items, so check it gets back to updated
+      Document merged;
+      merged.content_groups = original;
+      Document deltasDocument;
+      deltasDocument.content_groups = deltas;
+      mergeInPlace(merged, deltasDocument);
+
+      EOS_CHECK(std::equal(merged.content_groups.begin(), merged.content_groups.end(),
+                           updated.begin(), updated.end(), sameGroup),
+            "diff: updated document can not be reached by merging into original");
+
+      return deltas;
     }
 } // namespace hypha
@@ -1,5 +1,9 @@
+#include <limits>
+#include <set>
+
 #include <document_graph/document_graph.hpp>
 #include <document_graph/document.hpp>
+#include <document_graph/edge_indexes.hpp>
 #include <document_graph/util.hpp>
 #include <logger/logger.hpp>
 
@@ -7,21 +11,12 @@ namespace hypha
 {
     std::vector<Edge> DocumentGraph::getEdges(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode)
     {
-        std::vector<Edge> edges;
-
-        // this index uniquely identifies all edges that share this fromNode and toNode
-        uint64_t index = concatHash(fromNode, toNode);
-        Edge::edge_table e_t(m_contract, m_contract.value);
-        auto from_name_index = e_t.get_index<eosio::name("byfromto")>();
-        auto itr = from_name_index.find(index);
-
-        while (itr != from_name_index.end() && itr->by_from_node_to_node_index() == index)
-        {
-            edges.push_back(*itr);
-            itr++;
-        }
+        return edgesBetween(fromNode, toNode).toVector();
+    }
 
-        return edges;
+    EdgeRange DocumentGraph::edgesBetween(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode) const
+    {
+        return EdgeRange::between(m_contract, fromNode, toNode);
     }
 
     std::vector<Edge> DocumentGraph::getEdgesOrFail(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode)
@@ -33,21 +28,12 @@ namespace hypha
 
     std::vector<Edge> DocumentGraph::getEdgesFrom(const eosio::checksum256 &fromNode, const eosio::name &edgeName)
     {
-        std::vector<Edge> edges;
-
-        // this index uniquely identifies all edges that share this fromNode and edgeName
-        uint64_t index = concatHash(fromNode, edgeName);
-        Edge::edge_table e_t(m_contract, m_contract.value);
-        auto from_name_index = e_t.get_index<eosio::name("byfromname")>();
-        auto itr = from_name_index.find(index);
-
-        while (itr != from_name_index.end() && itr->by_from_node_edge_name_index() == index)
-        {
-            edges.push_back(*itr);
-            itr++;
-        }
+        return edgesFrom(fromNode, edgeName).toVector();
+    }
 
-        return edges;
+    EdgeRange DocumentGraph::edgesFrom(const eosio::checksum256 &fromNode, const eosio::name &edgeName) const
+    {
+        return EdgeRange::from(m_contract, fromNode, edgeName);
     }
 
     std::vector<Edge> DocumentGraph::getEdgesFromOrFail(const eosio::checksum256 &fromNode, const eosio::name &edgeName)
@@ -59,21 +45,12 @@ namespace hypha
 
     std::vector<Edge> DocumentGraph::getEdgesTo(const eosio::checksum256 &toNode, const eosio::name &edgeName)
     {
-        std::vector<Edge> edges;
-
-        // this index uniquely identifies all edges that share this toNode and edgeName
-        uint64_t index = concatHash(toNode, edgeName);
-        Edge::edge_table e_t(m_contract, m_contract.value);
-        auto from_name_index = e_t.get_index<eosio::name("bytoname")>();
-        auto itr = from_name_index.find(index);
-
-        while (itr != from_name_index.end() && itr->by_to_node_edge_name_index() == index)
-        {
-            edges.push_back(*itr);
-            itr++;
-        }
+        return edgesTo(toNode, edgeName).toVector();
+    }
 
-        return edges;
+    EdgeRange DocumentGraph::edgesTo(const eosio::checksum256 &toNode, const eosio::name &edgeName) const
+    {
+        return EdgeRange::to(m_contract, toNode, edgeName);
     }
 
     std::vector<Edge> DocumentGraph::getEdgesToOrFail(const eosio::checksum256 &toNode, const eosio::name &edgeName)
@@ -86,28 +63,82 @@ namespace hypha
     // since we are removing multiple edges here, we do not call erase on each edge, which
     // would instantiate the table on each call.  This is faster execution.
     void DocumentGraph::removeEdges(const eosio::checksum256 &node)
+    {
+        removeEdges(node, std::numeric_limits<uint64_t>::max());
+    }
+
+    uint64_t DocumentGraph::removeEdges(const eosio::checksum256 &node, const uint64_t limit)
     {
         Edge::edge_table e_t(m_contract, m_contract.value);
+        NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+        DocumentNode::node_table n_t(m_contract, m_contract.value);
+        return removeEdges(e_t, ne_t, n_t, node, limit);
+    }
+
+    uint64_t DocumentGraph::removeEdges(Edge::edge_table &e_t, NodeEdge::node_edge_table &ne_t, DocumentNode::node_table &n_t,
+                                        const eosio::checksum256 &node, const uint64_t limit)
+    {
+        uint64_t removed = 0;
+        const NodeIdState &nodeIds = Edge::getNodeIdState(m_contract);
+        if (nodeIds.enabled)
+        {
+            removed = removeNodeEdges(ne_t, n_t, node, limit);
+            if (!nodeIds.legacyEdges())
+            {
+                return removed;
+            }
+        }
 
         auto from_node_index = e_t.get_index<eosio::name("fromnode")>();
         auto from_itr = from_node_index.find(node);
 
-        while (from_itr != from_node_index.end() && from_itr->from_node == node)
+        while (removed < limit && from_itr != from_node_index.end() && from_itr->from_node == node)
         {
+            EdgeIndexes::adjust(m_contract, *from_itr, -1);
             from_itr = from_node_index.erase(from_itr);
+            removed++;
         }
 
         auto to_node_index = e_t.get_index<eosio::name("tonode")>();
         auto to_itr = to_node_index.find(node);
 
-        while (to_itr != to_node_index.end() && to_itr->to_node == node)
+        while (removed < limit && to_itr != to_node_index.end() && to_itr->to_node == node)
         {
+            EdgeIndexes::adjust(m_contract, *to_itr, -1);
             to_itr = to_node_index.erase(to_itr);
+            removed++;
         }
+        return removed;
     }
 
     bool DocumentGraph::hasEdges(const eosio::checksum256 &node)
     {
+        const NodeIdState &nodeIds = Edge::getNodeIdState(m_contract);
+        if (nodeIds.enabled)
+        {
+            if (auto id = DocumentNode::find(m_contract, node))
+            {
+                NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+                auto from_index = ne_t.get_index<eosio::name("byfromname")>();
+                auto from_itr = from_index.lower_bound(NodeEdge::nodeKey(*id, 0));
+                if (from_itr != from_index.end() && from_itr->from_node == *id)
+                {
+                    return true;
+                }
+
+                auto to_index = ne_t.get_index<eosio::name("bytoname")>();
+                auto to_itr = to_index.lower_bound(NodeEdge::nodeKey(*id, 0));
+                if (to_itr != to_index.end() && to_itr->to_node == *id)
+                {
+                    return true;
+                }
+            }
+            if (!nodeIds.legacyEdges())
+            {
+                return false;
+            }
+        }
+
         Edge::edge_table e_t(m_contract, m_contract.value);
         
         auto from_node_index = e_t.get_index<eosio::name("fromnode")>();
@@ -125,33 +156,845 @@ namespace hypha
         return false;
     }
 
-    void DocumentGraph::replaceNode(const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode)
+    // Re-points every edge of oldNode to newNode and returns how many edge rows were rewritten.
+    // Edges keep their creator and creation date.
+    uint64_t DocumentGraph::replaceNode(const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode)
     {
+        TRACE_FUNCTION()
+        const NodeIdState &nodeIds = Edge::getNodeIdState(m_contract);
+        if (nodeIds.enabled)
+        {
+            // finish the migration of this node's edges so they can all be re-pointed by id
+            const uint64_t moved = nodeIds.legacyEdges() ? moveNodeEdges(oldNode) : 0;
+            return moved + replaceNodeId(oldNode, newNode);
+        }
+
         Edge::edge_table e_t(m_contract, m_contract.value);
 
+        // collect first: rewritten rows are stored back into the indexes being walked
+        std::vector<uint64_t> ids;
         auto from_node_index = e_t.get_index<eosio::name("fromnode")>();
-        auto from_itr = from_node_index.find(oldNode);
+        for (auto from_itr = from_node_index.find(oldNode); from_itr != from_node_index.end() && from_itr->from_node == oldNode; ++from_itr)
+        {
+            ids.push_back(from_itr->id);
+        }
+
+        auto to_node_index = e_t.get_index<eosio::name("tonode")>();
+        for (auto to_itr = to_node_index.find(oldNode); to_itr != to_node_index.end() && to_itr->to_node == oldNode; ++to_itr)
+        {
+            // edges from oldNode to itself were collected above
+            if (to_itr->from_node != oldNode)
+            {
+                ids.push_back(to_itr->id);
+            }
+        }
+
+        // the primary key is derived from both hashes, so each row is stored again under its new keys
+        const std::uint8_t keyVersion = Edge::writeKeyVersion(m_contract);
+        for (uint64_t id : ids)
+        {
+            auto itr = e_t.find(id);
+            Edge edge = *itr;
+            if (edge.from_node == oldNode)
+            {
+                edge.from_node = newNode;
+            }
+            if (edge.to_node == oldNode)
+            {
+                edge.to_node = newNode;
+            }
+
+            EOS_CHECK(Edge::find(e_t, m_contract, edge.from_node, edge.to_node, edge.edge_name) == e_t.end(),
+                      util::to_str("Edge from: ", edge.from_node,
+                                   " to: ", edge.to_node,
+                                   " with name: ", edge.edge_name, " already exists"));
+
+            EdgeIndexes::adjust(m_contract, *itr, -1);
+            e_t.erase(itr);
+            edge.id = Edge::idKey(keyVersion, edge.from_node, edge.to_node, edge.edge_name);
+            e_t.emplace(m_contract, [&](auto &e) {
+                e = edge;
+                e.from_node_edge_name_index = Edge::fromNameKey(keyVersion, edge.from_node, edge.edge_name);
+                e.from_node_to_node_index = Edge::fromToKey(keyVersion, edge.from_node, edge.to_node);
+                e.to_node_edge_name_index = Edge::toNameKey(keyVersion, edge.to_node, edge.edge_name);
+            });
+            EdgeIndexes::adjust(m_contract, edge, 1);
+        }
+        return ids.size();
+    }
+
+    // Re-keys up to batchSize edges from the legacy hex-string keys to compositeKey. The
+    // position is kept in the edgekeys singleton, so any caller can continue the job.
+    // Rows already on the v2 scheme (including ones written during the migration) are
+    // recognised by their id and skipped. Returns true once the whole table is migrated.
+    bool DocumentGraph::migrateEdgeKeys(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        EdgeKeyState state = Edge::getKeyState(m_contract);
+        if (state.key_version == 2 && !state.migrating)
+        {
+            return true;
+        }
+
+        if (!state.migrating)
+        {
+            state.key_version = 2;
+            state.migrating = true;
+            state.cursor = 0;
+        }
+
+        Edge::edge_table e_t(m_contract, m_contract.value);
+        auto itr = e_t.lower_bound(state.cursor);
 
-        while (from_itr != from_node_index.end() && from_itr->from_node == oldNode)
+        for (uint64_t processed = 0; itr != e_t.end() && processed < batchSize; ++processed)
         {
-            // create the new edge record
-            Edge newEdge(m_contract, m_contract, newNode, from_itr->to_node, from_itr->edge_name);
+            const uint64_t newId = Edge::idKey(2, itr->from_node, itr->to_node, itr->edge_name);
+            if (itr->id == newId)
+            {
+                itr++;
+                continue;
+            }
 
-            // erase the old edge record
+            Edge edge = *itr;
+            EdgeIndexes::adjust(m_contract, edge, -1);
+            itr = e_t.erase(itr);
+
+            // a v2 row for the same edge can only exist if it was re-created mid-migration
+            if (e_t.find(newId) == e_t.end())
+            {
+                e_t.emplace(m_contract, [&](auto &e) {
+                    e = edge;
+                    e.id = newId;
+                    e.from_node_edge_name_index = Edge::fromNameKey(2, edge.from_node, edge.edge_name);
+                    e.from_node_to_node_index = Edge::fromToKey(2, edge.from_node, edge.to_node);
+                    e.to_node_edge_name_index = Edge::toNameKey(2, edge.to_node, edge.edge_name);
+                });
+                EdgeIndexes::adjust(m_contract, EdgeIndexes::EDGES, newId, edge.from_node, edge.to_node, edge.edge_name, 1);
+            }
+        }
+
+        state.migrating = itr != e_t.end();
+        state.cursor = state.migrating ? itr->primary_key() : 0;
+        Edge::setKeyState(m_contract, state);
+
+        return !state.migrating;
+    }
+
+    // The node row is erased once the node has no edges left.
+    uint64_t DocumentGraph::removeNodeEdges(NodeEdge::node_edge_table &ne_t, DocumentNode::node_table &n_t,
+                                            const eosio::checksum256 &node, const uint64_t limit)
+    {
+        auto node_index = n_t.get_index<eosio::name("idhash")>();
+        auto node_itr = node_index.find(node);
+        if (node_itr == node_index.end())
+        {
+            return 0;
+        }
+        const uint64_t id = node_itr->id;
+
+        uint64_t removed = 0;
+
+        auto from_index = ne_t.get_index<eosio::name("byfromname")>();
+        auto from_itr = from_index.lower_bound(NodeEdge::nodeKey(id, 0));
+        while (removed < limit && from_itr != from_index.end() && from_itr->from_node == id)
+        {
+            EdgeIndexes::adjust(m_contract, *from_itr, -1);
+            EdgeTime::remove(m_contract, from_itr->id);
+            from_itr = from_index.erase(from_itr);
+            removed++;
+        }
+
+        auto to_index = ne_t.get_index<eosio::name("bytoname")>();
+        auto to_itr = to_index.lower_bound(NodeEdge::nodeKey(id, 0));
+        while (removed < limit && to_itr != to_index.end() && to_itr->to_node == id)
+        {
+            EdgeIndexes::adjust(m_contract, *to_itr, -1);
+            EdgeTime::remove(m_contract, to_itr->id);
+            to_itr = to_index.erase(to_itr);
+            removed++;
+        }
+
+        if (removed < limit)
+        {
+            n_t.erase(n_t.find(id));
+        }
+        return removed;
+    }
+
+    // The common case, a new document taking over from the old one, only rewrites the hash of
+    // the old node. If the new document already has a node, the old node's edges move to it.
+    uint64_t DocumentGraph::replaceNodeId(const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode)
+    {
+        auto oldId = DocumentNode::find(m_contract, oldNode);
+        if (!oldId)
+        {
+            return 0;
+        }
+
+        DocumentNode::node_table n_t(m_contract, m_contract.value);
+        auto newId = DocumentNode::find(m_contract, newNode);
+        if (!newId)
+        {
+            n_t.modify(n_t.find(*oldId), m_contract, [&](auto &n) {
+                n.hash = newNode;
+            });
+            EdgeIndexes::renameNode(m_contract, oldNode, newNode);
+            return 0;
+        }
+
+        NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+        uint64_t moved = 0;
+        auto moveEdge = [&](const NodeEdge &edge, uint64_t fromNode, uint64_t toNode) {
+            EOS_CHECK(NodeEdge::find(ne_t, fromNode, toNode, edge.edge_name) == ne_t.end(),
+                      util::to_str("Edge from: ", DocumentNode::getHash(m_contract, fromNode),
+                                   " to: ", DocumentNode::getHash(m_contract, toNode),
+                                   " with name: ", edge.edge_name, " already exists"));
+            NodeEdge movedEdge = edge;
+            movedEdge.from_node = fromNode;
+            movedEdge.to_node = toNode;
+            EdgeIndexes::adjust(m_contract, edge, -1);
+            ne_t.modify(edge, m_contract, [&](auto &e) {
+                e = movedEdge;
+            });
+            EdgeIndexes::adjust(m_contract, movedEdge, 1);
+            EdgeTime::write(m_contract, movedEdge);
+            moved++;
+        };
+
+        // the indexes are keyed by the old id, so each modified row moves out of the range
+        auto from_index = ne_t.get_index<eosio::name("byfromname")>();
+        for (auto from_itr = from_index.lower_bound(NodeEdge::nodeKey(*oldId, 0));
+             from_itr != from_index.end() && from_itr->from_node == *oldId;
+             from_itr = from_index.lower_bound(NodeEdge::nodeKey(*oldId, 0)))
+        {
+            moveEdge(*from_itr, *newId, from_itr->to_node == *oldId ? *newId : from_itr->to_node);
+        }
+
+        auto to_index = ne_t.get_index<eosio::name("bytoname")>();
+        for (auto to_itr = to_index.lower_bound(NodeEdge::nodeKey(*oldId, 0));
+             to_itr != to_index.end() && to_itr->to_node == *oldId;
+             to_itr = to_index.lower_bound(NodeEdge::nodeKey(*oldId, 0)))
+        {
+            moveEdge(*to_itr, to_itr->from_node, *newId);
+        }
+
+        n_t.erase(n_t.find(*oldId));
+        return moved;
+    }
+
+    // Moves the rows of the edges table touching node to nodeedges, as migrateNodeIds would,
+    // and returns how many were moved.
+    uint64_t DocumentGraph::moveNodeEdges(const eosio::checksum256 &node)
+    {
+        uint64_t moved = 0;
+        Edge::edge_table e_t(m_contract, m_contract.value);
+        NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+
+        auto from_node_index = e_t.get_index<eosio::name("fromnode")>();
+        auto from_itr = from_node_index.find(node);
+        while (from_itr != from_node_index.end() && from_itr->from_node == node)
+        {
+            moveToNodeEdge(ne_t, *from_itr);
             from_itr = from_node_index.erase(from_itr);
+            moved++;
         }
 
         auto to_node_index = e_t.get_index<eosio::name("tonode")>();
-        auto to_itr = to_node_index.find(oldNode);
+        auto to_itr = to_node_index.find(node);
+        while (to_itr != to_node_index.end() && to_itr->to_node == node)
+        {
+            moveToNodeEdge(ne_t, *to_itr);
+            to_itr = to_node_index.erase(to_itr);
+            moved++;
+        }
+        return moved;
+    }
 
-        while (to_itr != to_node_index.end() && to_itr->to_node == oldNode)
+    void DocumentGraph::moveToNodeEdge(NodeEdge::node_edge_table &ne_t, const Edge &edge)
+    {
+        const uint64_t fromId = DocumentNode::getOrNew(m_contract, edge.from_node);
+        const uint64_t toId = DocumentNode::getOrNew(m_contract, edge.to_node);
+
+        // the row changes table and id, which decides whether a degree rebuild has counted it
+        EdgeIndexes::adjust(m_contract, edge, -1);
+        if (NodeEdge::find(ne_t, fromId, toId, edge.edge_name) == ne_t.end())
         {
-            // create the new edge record
-            Edge newEdge(m_contract, m_contract, to_itr->from_node, newNode, to_itr->edge_name);
+            const uint64_t id = ne_t.available_primary_key();
+            auto itr = ne_t.emplace(m_contract, [&](auto &e) {
+                e.id = id;
+                e.from_node = fromId;
+                e.to_node = toId;
+                e.edge_name = edge.edge_name;
+                e.created_date = edge.created_date;
+                e.creator = edge.creator;
+            });
+            EdgeIndexes::adjust(m_contract, EdgeIndexes::NODE_EDGES, id, edge.from_node, edge.to_node, edge.edge_name, 1);
+            EdgeTime::write(m_contract, *itr);
+        }
+    }
 
-            // erase the old edge record
-            to_itr = to_node_index.erase(to_itr);
+    // Turns on node id mode and moves up to batchSize rows from the edges table to nodeedges.
+    // Moved rows are erased, so each batch starts at the beginning of the edges table; edges
+    // written meanwhile already go to nodeedges. Returns true once the edges table is empty.
+    bool DocumentGraph::migrateNodeIds(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        NodeIdState state = Edge::getNodeIdState(m_contract);
+        if (state.enabled && !state.migrating)
+        {
+            return true;
         }
+
+        state.enabled = true;
+        state.migrating = true;
+        Edge::setNodeIdState(m_contract, state);
+
+        Edge::edge_table e_t(m_contract, m_contract.value);
+        NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+        auto itr = e_t.begin();
+
+        for (uint64_t processed = 0; itr != e_t.end() && processed < batchSize; ++processed)
+        {
+            moveToNodeEdge(ne_t, *itr);
+            itr = e_t.erase(itr);
+        }
+
+        state.migrating = itr != e_t.end();
+        Edge::setNodeIdState(m_contract, state);
+
+        return !state.migrating;
+    }
+
+    uint64_t DocumentGraph::degree(const eosio::checksum256 &node, const eosio::name &edgeName, const EdgeDirection direction) const
+    {
+        EOS_CHECK(Edge::getDegreeState(m_contract).ready(), "degree counters are not built; run the degree rebuild first");
+        return EdgeCounter::get(m_contract, node, edgeName, direction);
+    }
+
+    // Counts existing edges in primary key order, the nodeedges table first. The cursor in the
+    // degreestate singleton marks which rows are counted, so edges written or removed between
+    // batches update the counters only for rows the rebuild has passed. Returns true once both
+    // tables are counted.
+    bool DocumentGraph::rebuildDegrees(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        DegreeState state = Edge::getDegreeState(m_contract);
+        if (state.ready())
+        {
+            return true;
+        }
+
+        if (!state.enabled)
+        {
+            state.enabled = true;
+            state.rebuilding = true;
+            state.source = EdgeIndexes::NODE_EDGES;
+            state.cursor = 0;
+        }
+
+        EdgeCounter::counter_table c_t(m_contract, m_contract.value);
+        uint64_t processed = 0;
+
+        if (state.source == EdgeIndexes::NODE_EDGES)
+        {
+            NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+            auto itr = ne_t.lower_bound(state.cursor);
+            for (; itr != ne_t.end() && processed < batchSize; ++itr, ++processed)
+            {
+                const eosio::checksum256 fromNode = DocumentNode::getHash(m_contract, itr->from_node);
+                const eosio::checksum256 toNode = DocumentNode::getHash(m_contract, itr->to_node);
+                EdgeCounter::add(c_t, m_contract, fromNode, itr->edge_name, EdgeDirection::Out, 1);
+                EdgeCounter::add(c_t, m_contract, toNode, itr->edge_name, EdgeDirection::In, 1);
+            }
+
+            if (itr != ne_t.end())
+            {
+                state.cursor = itr->primary_key();
+            }
+            else
+            {
+                state.source = EdgeIndexes::EDGES;
+                state.cursor = 0;
+            }
+        }
+
+        if (state.source == EdgeIndexes::EDGES)
+        {
+            Edge::edge_table e_t(m_contract, m_contract.value);
+            auto itr = e_t.lower_bound(state.cursor);
+            for (; itr != e_t.end() && processed < batchSize; ++itr, ++processed)
+            {
+                EdgeCounter::add(c_t, m_contract, itr->from_node, itr->edge_name, EdgeDirection::Out, 1);
+                EdgeCounter::add(c_t, m_contract, itr->to_node, itr->edge_name, EdgeDirection::In, 1);
+            }
+
+            state.rebuilding = itr != e_t.end();
+            state.cursor = state.rebuilding ? itr->primary_key() : 0;
+        }
+
+        Edge::setDegreeState(m_contract, state);
+        return !state.rebuilding;
+    }
+
+    bool DocumentGraph::isAncestor(const eosio::checksum256 &ancestor, const eosio::checksum256 &descendant, const eosio::name &edgeName) const
+    {
+        return EdgeClosure::isAncestor(m_contract, ancestor, descendant, edgeName);
+    }
+
+    // Adds the paths of existing edgeName edges in primary key order, the nodeedges table first,
+    // with the same resumable cursor as rebuildDegrees. Calling it again for a built name only
+    // changes its bound. Returns true once both tables are walked.
+    bool DocumentGraph::buildClosure(const eosio::name &edgeName, const uint64_t maxUpdates, const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        ClosureState state = Edge::getClosureState(m_contract);
+        ClosureConfig *config = state.find(edgeName);
+        if (!config)
+        {
+            ClosureConfig added;
+            added.edge_name = edgeName;
+            added.source = EdgeIndexes::NODE_EDGES;
+            state.configs.push_back(added);
+            config = &state.configs.back();
+        }
+        config->max_updates = maxUpdates;
+
+        uint64_t processed = 0;
+        if (config->building && config->source == EdgeIndexes::NODE_EDGES)
+        {
+            NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+            auto itr = ne_t.lower_bound(config->cursor);
+            for (; itr != ne_t.end() && processed < batchSize; ++itr, ++processed)
+            {
+                if (itr->edge_name == edgeName)
+                {
+                    EdgeClosure::apply(m_contract, *config,
+                                       DocumentNode::getHash(m_contract, itr->from_node),
+                                       DocumentNode::getHash(m_contract, itr->to_node), 1);
+                }
+            }
+
+            if (itr != ne_t.end())
+            {
+                config->cursor = itr->primary_key();
+            }
+            else
+            {
+                config->source = EdgeIndexes::EDGES;
+                config->cursor = 0;
+            }
+        }
+
+        if (config->building && config->source == EdgeIndexes::EDGES)
+        {
+            Edge::edge_table e_t(m_contract, m_contract.value);
+            auto itr = e_t.lower_bound(config->cursor);
+            for (; itr != e_t.end() && processed < batchSize; ++itr, ++processed)
+            {
+                if (itr->edge_name == edgeName)
+                {
+                    EdgeClosure::apply(m_contract, *config, itr->from_node, itr->to_node, 1);
+                }
+            }
+
+            config->building = itr != e_t.end();
+            config->cursor = config->building ? itr->primary_key() : 0;
+        }
+
+        const bool built = !config->building;
+        Edge::setClosureState(m_contract, state);
+        return built;
+    }
+
+    TraversalToken DocumentGraph::traverse(const eosio::checksum256 &start, const TraversalSpec &spec, const TraversalVisitor &visitor) const
+    {
+        return resumeTraversal(GraphTraversal::start(start), spec, visitor);
+    }
+
+    TraversalToken DocumentGraph::resumeTraversal(TraversalToken token, const TraversalSpec &spec, const TraversalVisitor &visitor) const
+    {
+        GraphTraversal::run(m_contract, token, spec, visitor);
+        return token;
+    }
+
+    std::optional<std::vector<Edge>> DocumentGraph::findPath(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                                                             const std::vector<eosio::name> &edgeNames, const uint32_t maxHops) const
+    {
+        return GraphTraversal::findPath(m_contract, fromNode, toNode, edgeNames, maxHops);
+    }
+
+    bool DocumentGraph::isReachable(const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                                    const std::vector<eosio::name> &edgeNames, const uint32_t maxHops) const
+    {
+        return findPath(fromNode, toNode, edgeNames, maxHops).has_value();
+    }
+
+    EdgePage DocumentGraph::edgesByTime(const eosio::checksum256 &node, const eosio::name &edgeName,
+                                        const EdgeDirection direction, const EdgeOrder order, const uint32_t limit,
+                                        const std::optional<EdgeTimeCursor> &after) const
+    {
+        EOS_CHECK(Edge::getTimeIndexState(m_contract).ready(), "edge time index is not built; run the edge time build first");
+
+        EdgePage page;
+        auto id = DocumentNode::find(m_contract, node);
+        if (!id || limit == 0)
+        {
+            return page;
+        }
+
+        EdgeTime::time_table t_t(m_contract, m_contract.value);
+        NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+
+        auto walk = [&](const auto &index, auto nodeOf) {
+            auto inRange = [&](const EdgeTime &t) { return nodeOf(t) == *id && t.edge_name == edgeName; };
+            auto add = [&](const EdgeTime &t) {
+                const NodeEdge &nodeEdge = *ne_t.find(t.id);
+                page.edges.push_back(direction == EdgeDirection::Out
+                                         ? Edge::fromNodeEdge(m_contract, nodeEdge, node, DocumentNode::getHash(m_contract, t.to_node))
+                                         : Edge::fromNodeEdge(m_contract, nodeEdge, DocumentNode::getHash(m_contract, t.from_node), node));
+                page.next = EdgeTimeCursor{t.created_date, t.id};
+            };
+
+            if (order == EdgeOrder::OldestFirst)
+            {
+                auto itr = after ? index.upper_bound(EdgeTime::timeKey(*id, edgeName, after->created_date, after->id))
+                                 : index.lower_bound(EdgeTime::timeKey(*id, edgeName, eosio::time_point(), 0));
+                for (; itr != index.end() && inRange(*itr) && page.edges.size() < limit; ++itr)
+                {
+                    add(*itr);
+                }
+                return;
+            }
+
+            // walk back from the first key past the page
+            const eosio::time_point latest(eosio::microseconds(std::numeric_limits<int64_t>::max()));
+            auto itr = index.lower_bound(after ? EdgeTime::timeKey(*id, edgeName, after->created_date, after->id)
+                                               : EdgeTime::timeKey(*id, edgeName, latest, std::numeric_limits<uint64_t>::max()));
+            const auto begin = index.begin();
+            while (itr != begin && page.edges.size() < limit)
+            {
+                --itr;
+                if (!inRange(*itr))
+                {
+                    break;
+                }
+                add(*itr);
+            }
+        };
+
+        if (direction == EdgeDirection::Out)
+        {
+            walk(t_t.get_index<eosio::name("byfromtime")>(), [](const EdgeTime &t) { return t.from_node; });
+        }
+        else
+        {
+            walk(t_t.get_index<eosio::name("bytotime")>(), [](const EdgeTime &t) { return t.to_node; });
+        }
+
+        // a short page is the last one
+        if (page.edges.size() < limit)
+        {
+            page.next.reset();
+        }
+        return page;
+    }
+
+    // Indexes nodeedges rows in primary key order. Edges written meanwhile get their row from
+    // the build once it reaches them, so only the rows behind the cursor are kept by writes.
+    // Returns true once the whole table is indexed.
+    bool DocumentGraph::buildEdgeTimes(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        EdgeTimeState state = Edge::getTimeIndexState(m_contract);
+        if (state.ready())
+        {
+            return true;
+        }
+
+        const NodeIdState &nodeIds = Edge::getNodeIdState(m_contract);
+        EOS_CHECK(nodeIds.enabled && !nodeIds.migrating, "the edge time index needs node ids; complete the node id migration first");
+
+        if (!state.enabled)
+        {
+            state.enabled = true;
+            state.building = true;
+            state.cursor = 0;
+        }
+
+        EdgeTime::time_table t_t(m_contract, m_contract.value);
+        NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+        auto itr = ne_t.lower_bound(state.cursor);
+        for (uint64_t processed = 0; itr != ne_t.end() && processed < batchSize; ++itr, ++processed)
+        {
+            t_t.emplace(m_contract, [&](auto &t) {
+                t.id = itr->id;
+                t.from_node = itr->from_node;
+                t.to_node = itr->to_node;
+                t.edge_name = itr->edge_name;
+                t.created_date = itr->created_date;
+            });
+        }
+
+        state.building = itr != ne_t.end();
+        state.cursor = state.building ? itr->primary_key() : 0;
+        Edge::setTimeIndexState(m_contract, state);
+
+        return !state.building;
+    }
+
+    // A batch that removes fewer than batchSize edges found none left, so the document goes with it.
+    // Edges created meanwhile are removed by later batches. If the document was updated or erased
+    // in the meantime, the job only finishes removing the edges still attached to the hash.
+    bool DocumentGraph::eraseDocumentInBatches(const eosio::checksum256 &documentHash, const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        EOS_CHECK(batchSize > 0, "batch size must be greater than zero");
+
+        PendingDeletion::deletion_table del_t(m_contract, m_contract.value);
+        auto hash_index = del_t.get_index<eosio::name("idhash")>();
+        auto itr = hash_index.find(documentHash);
+        if (itr == hash_index.end())
+        {
+            EOS_CHECK(Document::exists(m_contract, documentHash), "Cannot erase document; does not exist: " + readableHash(documentHash));
+            const uint64_t id = del_t.available_primary_key();
+            del_t.emplace(m_contract, [&](auto &d) {
+                d.id = id;
+                d.document_hash = documentHash;
+                d.started = eosio::current_time_point();
+            });
+            itr = hash_index.find(documentHash);
+        }
+
+        const uint64_t removed = removeEdges(documentHash, batchSize);
+        if (removed == batchSize)
+        {
+            hash_index.modify(itr, m_contract, [&](auto &d) {
+                d.edges_removed += removed;
+                d.batches++;
+            });
+            return false;
+        }
+
+        if (Document::exists(m_contract, documentHash))
+        {
+            eraseDocument(documentHash, false);
+        }
+        hash_index.erase(itr);
+        return true;
+    }
+
+    std::optional<PendingDeletion> DocumentGraph::getPendingDeletion(const eosio::checksum256 &documentHash)
+    {
+        PendingDeletion::deletion_table del_t(m_contract, m_contract.value);
+        auto hash_index = del_t.get_index<eosio::name("idhash")>();
+        auto itr = hash_index.find(documentHash);
+        if (itr == hash_index.end())
+        {
+            return std::nullopt;
+        }
+        return *itr;
+    }
+
+    // Table handles and lookups shared by the operations of one batch. Every edge, node edge and
+    // node row write of the batch goes through these handles, so their cached rows stay current.
+    struct DocumentGraph::Batch
+    {
+        Batch(const eosio::name &contract)
+            : e_t(contract, contract.value), ne_t(contract, contract.value), n_t(contract, contract.value) {}
+
+        Edge::edge_table e_t;
+        NodeEdge::node_edge_table ne_t;
+        DocumentNode::node_table n_t;
+
+        // node ids looked up or created by the batch
+        std::map<eosio::checksum256, uint64_t> nodeIds;
+        // edge names already validated
+        std::set<uint64_t> checkedNames;
+        // documents created so far, by operation index
+        std::map<uint32_t, eosio::checksum256> created;
+
+        std::optional<uint64_t> findNode(const eosio::checksum256 &hash)
+        {
+            auto cached = nodeIds.find(hash);
+            if (cached != nodeIds.end())
+            {
+                return cached->second;
+            }
+
+            auto hash_index = n_t.get_index<eosio::name("idhash")>();
+            auto itr = hash_index.find(hash);
+            if (itr == hash_index.end())
+            {
+                return std::nullopt;
+            }
+            return nodeIds[hash] = itr->id;
+        }
+
+        uint64_t getOrNewNode(const eosio::name &contract, const eosio::checksum256 &hash)
+        {
+            if (auto id = findNode(hash))
+            {
+                return *id;
+            }
+
+            const uint64_t id = n_t.available_primary_key();
+            n_t.emplace(contract, [&](auto &n) {
+                n.id = id;
+                n.hash = hash;
+            });
+            return nodeIds[hash] = id;
+        }
+
+        // the nodeedges row of the edge, or ne_t.end()
+        NodeEdge::node_edge_table::const_iterator findNodeEdge(const eosio::checksum256 &fromNode,
+                                                               const eosio::checksum256 &toNode,
+                                                               const eosio::name &edgeName)
+        {
+            auto fromId = findNode(fromNode);
+            auto toId = fromId ? findNode(toNode) : std::nullopt;
+            return toId ? NodeEdge::find(ne_t, *fromId, *toId, edgeName) : ne_t.end();
+        }
+
+        const eosio::checksum256 &resolve(const std::optional<uint32_t> &op, const eosio::checksum256 &hash)
+        {
+            if (!op)
+            {
+                return hash;
+            }
+
+            auto itr = created.find(*op);
+            EOS_CHECK(itr != created.end(), "batch operation " + std::to_string(*op) + " did not create a document before it was referenced");
+            return itr->second;
+        }
+    };
+
+    // Runs the operations in order within one action; any failure aborts the whole batch.
+    // Returns the hashes of the created documents, in order.
+    std::vector<eosio::checksum256> DocumentGraph::applyBatch(const std::vector<GraphOperation> &operations)
+    {
+        TRACE_FUNCTION()
+        Batch batch(m_contract);
+        std::vector<eosio::checksum256> createdHashes;
+
+        for (uint32_t i = 0; i < operations.size(); ++i)
+        {
+            const GraphOperation &operation = operations[i];
+            const eosio::checksum256 &fromNode = batch.resolve(operation.from_op, operation.from_node);
+
+            if (operation.type == eosio::name("create"))
+            {
+                Document document(m_contract, operation.creator, operation.content_groups);
+                batch.created[i] = document.getHash();
+                createdHashes.push_back(document.getHash());
+                m_documentCache.emplace(document.getHash(), std::move(document));
+            }
+            else if (operation.type == eosio::name("newedge"))
+            {
+                batchWriteEdge(batch, operation.creator, fromNode, batch.resolve(operation.to_op, operation.to_node), operation.edge_name);
+            }
+            else if (operation.type == eosio::name("removeedge"))
+            {
+                batchRemoveEdge(batch, fromNode, batch.resolve(operation.to_op, operation.to_node), operation.edge_name);
+            }
+            else if (operation.type == eosio::name("erase"))
+            {
+                // eraseDocument fails for a missing document, which reverts the edge removal too
+                removeEdges(batch.e_t, batch.ne_t, batch.n_t, fromNode, std::numeric_limits<uint64_t>::max());
+                // removing the last edge also erases the node row, through batch.n_t
+                batch.nodeIds.erase(fromNode);
+                eraseDocument(fromNode, false);
+            }
+            else
+            {
+                EOS_CHECK(false, "unknown batch operation type: " + operation.type.to_string());
+            }
+        }
+        return createdHashes;
+    }
+
+    void DocumentGraph::batchWriteEdge(Batch &batch, const eosio::name &creator, const eosio::checksum256 &fromNode,
+                                       const eosio::checksum256 &toNode, const eosio::name &edgeName)
+    {
+        if (batch.checkedNames.insert(edgeName.value).second)
+        {
+            Edge::checkName(edgeName);
+        }
+
+        const NodeIdState &nodeIds = Edge::getNodeIdState(m_contract);
+        EOS_CHECK((!nodeIds.enabled || batch.findNodeEdge(fromNode, toNode, edgeName) == batch.ne_t.end()) &&
+                      Edge::find(batch.e_t, m_contract, fromNode, toNode, edgeName) == batch.e_t.end(),
+                  util::to_str("Edge from: ", fromNode,
+                               " to: ", toNode,
+                               " with name: ", edgeName, " already exists"));
+
+        if (nodeIds.enabled)
+        {
+            const uint64_t fromId = batch.getOrNewNode(m_contract, fromNode);
+            const uint64_t toId = batch.getOrNewNode(m_contract, toNode);
+            const uint64_t id = batch.ne_t.available_primary_key();
+            auto itr = batch.ne_t.emplace(m_contract, [&](auto &e) {
+                e.id = id;
+                e.from_node = fromId;
+                e.to_node = toId;
+                e.edge_name = edgeName;
+                e.created_date = eosio::current_time_point();
+                e.creator = creator;
+            });
+            EdgeIndexes::adjust(m_contract, EdgeIndexes::NODE_EDGES, id, fromNode, toNode, edgeName, 1);
+            EdgeTime::write(m_contract, *itr);
+            return;
+        }
+
+        const std::uint8_t keyVersion = Edge::writeKeyVersion(m_contract);
+        const uint64_t id = Edge::idKey(keyVersion, fromNode, toNode, edgeName);
+        batch.e_t.emplace(m_contract, [&](auto &e) {
+            e.id = id;
+            e.from_node_edge_name_index = Edge::fromNameKey(keyVersion, fromNode, edgeName);
+            e.from_node_to_node_index = Edge::fromToKey(keyVersion, fromNode, toNode);
+            e.to_node_edge_name_index = Edge::toNameKey(keyVersion, toNode, edgeName);
+            e.creator = creator;
+            e.contract = m_contract;
+            e.from_node = fromNode;
+            e.to_node = toNode;
+            e.edge_name = edgeName;
+            e.created_date = eosio::current_time_point();
+        });
+        EdgeIndexes::adjust(m_contract, EdgeIndexes::EDGES, id, fromNode, toNode, edgeName, 1);
+    }
+
+    void DocumentGraph::batchRemoveEdge(Batch &batch, const eosio::checksum256 &fromNode,
+                                        const eosio::checksum256 &toNode, const eosio::name &edgeName)
+    {
+        if (Edge::getNodeIdState(m_contract).enabled)
+        {
+            auto itr = batch.findNodeEdge(fromNode, toNode, edgeName);
+            if (itr != batch.ne_t.end())
+            {
+                EdgeIndexes::adjust(m_contract, EdgeIndexes::NODE_EDGES, itr->id, fromNode, toNode, edgeName, -1);
+                EdgeTime::remove(m_contract, itr->id);
+                batch.ne_t.erase(itr);
+                return;
+            }
+        }
+
+        auto itr = Edge::find(batch.e_t, m_contract, fromNode, toNode, edgeName);
+        EOS_CHECK(itr != batch.e_t.end(),
+                  "edge does not exist: from " + readableHash(fromNode) + " to " + readableHash(toNode) + " with edge name of " + edgeName.to_string());
+        EdgeIndexes::adjust(m_contract, *itr, -1);
+        batch.e_t.erase(itr);
+    }
+
+    const Document &DocumentGraph::getDocument(const eosio::checksum256 &documentHash)
+    {
+        auto cached = m_documentCache.find(documentHash);
+        if (cached != m_documentCache.end())
+        {
+            m_cacheStats.hits++;
+            return cached->second;
+        }
+
+        m_cacheStats.misses++;
+        return m_documentCache.emplace(documentHash, Document(m_contract, documentHash)).first->second;
     }
 
     Document DocumentGraph::updateDocument(const eosio::name &updater,
@@ -159,29 +1002,178 @@ namespace hypha
                                            ContentGroups contentGroups)
     {
         TRACE_FUNCTION()
-        Document currentDocument(m_contract, documentHash);
-        Document newDocument(m_contract, updater, contentGroups);
+        // fails if the document does not exist
+        const Document &currentDocument = getDocument(documentHash);
+        Document newDocument = Document::emplaceRevision(currentDocument, updater, contentGroups);
 
         replaceNode(documentHash, newDocument.getHash());
-        eraseDocument(documentHash, false);
+        eraseDocument(documentHash, false, newDocument.getGroupKeys());
         return newDocument;
     }
 
+    Document DocumentGraph::mergeDocument(const eosio::name &updater,
+                                          const eosio::checksum256 &documentHash,
+                                          const Document &deltas)
+    {
+        TRACE_FUNCTION()
+        // fails if the document does not exist
+        const Document &currentDocument = getDocument(documentHash);
+        Document newDocument = Document::emplaceMerge(currentDocument, updater, deltas);
+
+        replaceNode(documentHash, newDocument.getHash());
+        eraseDocument(documentHash, false, newDocument.getGroupKeys());
+        return newDocument;
+    }
+
+    // Moves up to batchSize documents from sequential ids to hash-derived primary keys.
+    // Like migrateEdgeKeys, the position is kept in the dockeys singleton and rows already
+    // within their probe range are skipped. Returns true once the whole table is migrated.
+    bool DocumentGraph::migrateDocumentKeys(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        DocumentKeyState state = Document::getKeyState(m_contract);
+        if (state.key_version == 2 && !state.migrating)
+        {
+            return true;
+        }
+
+        if (!state.migrating)
+        {
+            // switch first, so the re-inserted rows below get hash-derived keys
+            state.key_version = 2;
+            state.migrating = true;
+            state.cursor = 0;
+            Document::setKeyState(m_contract, state);
+        }
+
+        Document::document_table d_t(m_contract, m_contract.value);
+        auto itr = d_t.lower_bound(state.cursor);
+
+        for (uint64_t processed = 0; itr != d_t.end() && processed < batchSize; ++processed)
+        {
+            if (itr->primary_key() - Document::hashKey(itr->getHash()) < Document::MAX_KEY_PROBES)
+            {
+                itr++;
+                continue;
+            }
+
+            auto next = itr;
+            next++;
+            const bool last = next == d_t.end();
+            const uint64_t nextKey = last ? 0 : next->primary_key();
+
+            Document document = *itr;
+            Document::eraseRow(d_t, itr);
+
+            Document::emplaceAt(d_t, document, Document::nextPrimaryKey(d_t, document.getHash()));
+
+            itr = last ? d_t.end() : d_t.lower_bound(nextKey);
+        }
+
+        state.migrating = itr != d_t.end();
+        state.cursor = state.migrating ? itr->primary_key() : 0;
+        Document::setKeyState(m_contract, state);
+
+        return !state.migrating;
+    }
+
+    // Header storage is switched on before the first batch, so documents written while the
+    // backfill runs get their header on write and are skipped here. Reads move to the header
+    // table only once every older row has one.
+    bool DocumentGraph::migrateDocumentHeaders(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        DocumentHeaderState state = Document::getHeaderState(m_contract);
+        if (state.complete)
+        {
+            return true;
+        }
+
+        if (!state.migrating)
+        {
+            state.migrating = true;
+            state.cursor = 0;
+            Document::setHeaderState(m_contract, state);
+        }
+
+        Document::document_table d_t(m_contract, m_contract.value);
+        DocumentHeader::header_table h_t(m_contract, m_contract.value);
+        auto itr = d_t.lower_bound(state.cursor);
+
+        for (uint64_t processed = 0; itr != d_t.end() && processed < batchSize; ++processed, ++itr)
+        {
+            if (h_t.find(itr->primary_key()) == h_t.end())
+            {
+                h_t.emplace(m_contract, [&](auto &h) {
+                    h = itr->getHeader();
+                });
+            }
+        }
+
+        state.complete = itr == d_t.end();
+        state.migrating = !state.complete;
+        state.cursor = state.complete ? 0 : itr->primary_key();
+        Document::setHeaderState(m_contract, state);
+
+        return state.complete;
+    }
+
+    // Reads raw rows so the hash is recomputed from the stored content, whatever the load mode.
+    // Mismatches are counted rather than failing the action, so a pass always finishes.
+    DocumentAuditState DocumentGraph::auditDocuments(const uint64_t batchSize)
+    {
+        TRACE_FUNCTION()
+        Document::document_audit_singleton audit(m_contract, m_contract.value);
+        DocumentAuditState state = audit.get_or_default(DocumentAuditState{});
+
+        if (!state.running)
+        {
+            state = DocumentAuditState{};
+            state.running = true;
+        }
+
+        Document::document_table d_t(m_contract, m_contract.value);
+        auto itr = d_t.lower_bound(state.cursor);
+
+        for (uint64_t processed = 0; itr != d_t.end() && processed < batchSize; ++processed, ++itr)
+        {
+            state.checked++;
+            if (!itr->hasValidHash())
+            {
+                state.mismatches++;
+                state.last_mismatch = itr->getHash();
+            }
+        }
+
+        state.running = itr != d_t.end();
+        state.cursor = state.running ? itr->primary_key() : 0;
+        audit.set(state, m_contract);
+
+        return state;
+    }
+
     // for now, permissions should be handled in the contract action rather than this class
     void DocumentGraph::eraseDocument(const eosio::checksum256 &documentHash, const bool includeEdges)
+    {
+        eraseDocument(documentHash, includeEdges, std::vector<uint64_t>{});
+    }
+
+    void DocumentGraph::eraseDocument(const eosio::checksum256 &documentHash, const bool includeEdges,
+                                      const std::vector<uint64_t> &keptGroupKeys)
     {
         Document::document_table d_t(m_contract, m_contract.value);
-        auto hash_index = d_t.get_index<eosio::name("idhash")>();
-        auto h_itr = hash_index.find(documentHash);
+        auto h_itr = Document::findByHash(d_t, documentHash);
 
-        EOS_CHECK(h_itr != hash_index.end(), "Cannot erase document; does not exist: " + readableHash(documentHash));
+        EOS_CHECK(h_itr != d_t.end(), "Cannot erase document; does not exist: " + readableHash(documentHash));
 
         if (includeEdges)
         {
             removeEdges(documentHash);
         }
 
-        hash_index.erase(h_itr);
+        Document::releaseGroups(m_contract, h_itr->getGroupKeys(), keptGroupKeys);
+        Document::eraseRow(d_t, h_itr);
+        m_documentCache.erase(documentHash);
     }
 
     void DocumentGraph::eraseDocument(const eosio::checksum256 &documentHash)
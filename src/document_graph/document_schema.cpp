@@ -0,0 +1,21 @@
+#include <document_graph/document_schema.hpp>
+#include <logger/logger.hpp>
+
+namespace hypha
+{
+    namespace schema_detail
+    {
+        ContentGroup &groupFor(ContentGroups &contentGroups, std::string_view group)
+        {
+            for (ContentGroup &contentGroup : contentGroups)
+            {
+                if (ContentWrapper::getGroupLabel(contentGroup) == group)
+                {
+                    return contentGroup;
+                }
+            }
+            contentGroups.push_back(ContentGroup{Content{CONTENT_GROUP_LABEL, std::string(group)}});
+            return contentGroups.back();
+        }
+    } // namespace schema_detail
+} // namespace hypha
\ No newline at end of file
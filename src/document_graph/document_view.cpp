@@ -0,0 +1,368 @@
+#include <document_graph/document_view.hpp>
+#include <document_graph/util.hpp>
+#include <logger/logger.hpp>
+
+#include <eosio/datastream.hpp>
+
+namespace hypha
+{
+    namespace
+    {
+        // serialized size of each FlexValue alternative, in declaration order; -1 marks the
+        // length-prefixed string
+        constexpr int32_t FLEX_VALUE_SIZES[] = {0, 8, -1, 16, 8, 8, 32};
+        constexpr uint32_t FLEX_STRING = 2;
+        static_assert(std::variant_size_v<Content::FlexValue> == sizeof(FLEX_VALUE_SIZES) / sizeof(FLEX_VALUE_SIZES[0]),
+                      "FLEX_VALUE_SIZES must list every FlexValue alternative");
+
+        // walks a serialized row without decoding it
+        struct RowReader
+        {
+            const char *begin;
+            const char *pos;
+            const char *end;
+
+            uint32_t offset() const { return static_cast<uint32_t>(pos - begin); }
+
+            void skip(std::size_t size)
+            {
+                EOS_CHECK(static_cast<std::size_t>(end - pos) >= size, "document row is truncated");
+                pos += size;
+            }
+
+            uint32_t varint()
+            {
+                uint64_t value = 0;
+                uint8_t shift = 0;
+                uint8_t byte = 0;
+                do
+                {
+                    skip(1);
+                    byte = static_cast<uint8_t>(pos[-1]);
+                    value |= uint64_t(byte & 0x7f) << shift;
+                    shift += 7;
+                } while (byte & 0x80);
+                return static_cast<uint32_t>(value);
+            }
+
+            std::string_view string()
+            {
+                uint32_t size = varint();
+                const char *start = pos;
+                skip(size);
+                return std::string_view(start, size);
+            }
+
+            // skips a FlexValue, returning its type index
+            uint32_t value()
+            {
+                uint32_t type = varint();
+                EOS_CHECK(type < std::variant_size_v<Content::FlexValue>, "document row holds an unknown value type");
+                if (type == FLEX_STRING)
+                {
+                    string();
+                }
+                else
+                {
+                    skip(FLEX_VALUE_SIZES[type]);
+                }
+                return type;
+            }
+        };
+
+        // walks one serialized ContentGroup, returning its bytes and its content_group_label
+        std::string_view walkGroup(RowReader &reader, std::string_view &groupLabel)
+        {
+            const char *begin = reader.pos;
+            uint32_t itemCount = reader.varint();
+            for (uint32_t i = 0; i < itemCount; ++i)
+            {
+                std::string_view label = reader.string();
+                const char *value = reader.pos;
+                uint32_t type = reader.value();
+
+                if (label == CONTENT_GROUP_LABEL && groupLabel.empty())
+                {
+                    EOS_CHECK(type == FLEX_STRING, "fatal error: " + CONTENT_GROUP_LABEL + " must be a string");
+                    RowReader labelReader{reader.begin, value, reader.pos};
+                    labelReader.varint();
+                    groupLabel = labelReader.string();
+                }
+            }
+            return std::string_view(begin, reader.pos - begin);
+        }
+
+        std::optional<std::vector<char>> readRowAt(const eosio::name &contract, const eosio::name &table, const uint64_t key)
+        {
+            using namespace eosio::internal_use_do_not_use;
+            int32_t itr = db_find_i64(contract.value, contract.value, table.value, key);
+            if (itr < 0)
+            {
+                return std::nullopt;
+            }
+
+            std::vector<char> row(db_get_i64(itr, nullptr, 0));
+            db_get_i64(itr, row.data(), row.size());
+            return row;
+        }
+
+        eosio::checksum256 rowHash(const std::vector<char> &row)
+        {
+            uint64_t id;
+            eosio::checksum256 hash;
+            eosio::datastream<const char *> ds(row.data(), row.size());
+            ds >> id >> hash;
+            return hash;
+        }
+    } // namespace
+
+    // follows Document::findByHash, but reads raw rows so nothing past the header is decoded
+    std::optional<std::vector<char>> DocumentView::readRow(const eosio::name &contract, const eosio::checksum256 &hash)
+    {
+        const DocumentKeyState &state = Document::getKeyState(contract);
+        if (state.key_version == 2)
+        {
+            uint64_t key = Document::hashKey(hash);
+            for (uint64_t probe = 0; probe < Document::MAX_KEY_PROBES; ++probe, ++key)
+            {
+                auto row = readRowAt(contract, eosio::name("documents"), key);
+                if (!row)
+                {
+                    break;
+                }
+                if (rowHash(*row) == hash)
+                {
+                    return row;
+                }
+            }
+
+            if (!state.migrating)
+            {
+                return std::nullopt;
+            }
+        }
+
+        // idhash is the first secondary index of the documents table
+        uint64_t key;
+        auto words = hash.get_array();
+        const uint64_t idhashTable = (eosio::name("documents").value & 0xFFFFFFFFFFFFFFF0ULL) | 0;
+        if (eosio::internal_use_do_not_use::db_idx256_find_secondary(contract.value, contract.value, idhashTable,
+                                                                      words.data(), words.size(), &key) < 0)
+        {
+            return std::nullopt;
+        }
+        return readRowAt(contract, eosio::name("documents"), key);
+    }
+
+    DocumentView::DocumentView(const eosio::name &contract, const eosio::checksum256 &hash)
+    {
+        TRACE_FUNCTION()
+        auto row = readRow(contract, hash);
+        EOS_CHECK(row.has_value(), "document not found: " + readableHash(hash));
+        m_row = std::move(*row);
+
+        eosio::datastream<const char *> ds(m_row.data(), m_row.size());
+        ds >> m_id >> m_hash >> m_creator;
+    }
+
+    bool DocumentView::exists(const eosio::name &contract, const eosio::checksum256 &hash)
+    {
+        if (Document::getHeaderState(contract).complete)
+        {
+            return Document::getHeader(contract, hash).has_value();
+        }
+        return readRow(contract, hash).has_value();
+    }
+
+    void DocumentView::index()
+    {
+        if (m_indexed)
+        {
+            return;
+        }
+
+        RowReader reader{m_row.data(), m_row.data(), m_row.data() + m_row.size()};
+        reader.skip(sizeof(m_id) + sizeof(m_hash) + sizeof(m_creator));
+
+        uint32_t groupCount = reader.varint();
+        m_groups.reserve(groupCount);
+        for (uint32_t g = 0; g < groupCount; ++g)
+        {
+            GroupSpan span;
+            span.bytes = walkGroup(reader, span.label);
+            m_groups.push_back(span);
+        }
+
+        // certificates: certifier, notes, certification_date
+        uint32_t certificateCount = reader.varint();
+        for (uint32_t i = 0; i < certificateCount; ++i)
+        {
+            reader.skip(sizeof(uint64_t));
+            reader.string();
+            reader.skip(sizeof(int64_t));
+        }
+
+        m_created = reader.offset();
+        reader.skip(sizeof(int64_t));
+
+        eosio::name contract;
+        eosio::datastream<const char *> contractStream(reader.pos, reader.end - reader.pos);
+        contractStream >> contract;
+        reader.skip(sizeof(uint64_t));
+
+        // rows saved with group storage end with the ids of their group rows
+        if (reader.pos != reader.end)
+        {
+            uint32_t keyCount = reader.varint();
+            m_groupRows.reserve(keyCount);
+            m_groups.reserve(keyCount);
+            for (uint32_t k = 0; k < keyCount; ++k)
+            {
+                uint64_t key;
+                eosio::datastream<const char *> ds(reader.pos, reader.end - reader.pos);
+                ds >> key;
+                reader.skip(sizeof(key));
+
+                auto row = readRowAt(contract, eosio::name("docgroups"), key);
+                EOS_CHECK(row.has_value(), "document group not found: " + std::to_string(key));
+                m_groupRows.push_back(std::move(*row));
+
+                // group row: id, hash, references, then the content group
+                const std::vector<char> &groupRow = m_groupRows.back();
+                RowReader groupReader{groupRow.data(), groupRow.data(), groupRow.data() + groupRow.size()};
+                groupReader.skip(sizeof(uint64_t) + sizeof(eosio::checksum256) + sizeof(uint32_t));
+                GroupSpan span;
+                span.bytes = walkGroup(groupReader, span.label);
+                m_groups.push_back(span);
+            }
+        }
+
+        m_indexed = true;
+    }
+
+    const DocumentView::GroupSpan *DocumentView::findGroup(const std::string &label)
+    {
+        index();
+        for (const GroupSpan &span : m_groups)
+        {
+            if (span.label == label)
+            {
+                return &span;
+            }
+        }
+        return nullptr;
+    }
+
+    eosio::time_point DocumentView::getCreated()
+    {
+        index();
+        eosio::time_point created;
+        eosio::datastream<const char *> ds(m_row.data() + m_created, sizeof(int64_t));
+        ds >> created;
+        return created;
+    }
+
+    eosio::name DocumentView::getContract()
+    {
+        index();
+        eosio::name contract;
+        eosio::datastream<const char *> ds(m_row.data() + m_created + sizeof(int64_t), sizeof(uint64_t));
+        ds >> contract;
+        return contract;
+    }
+
+    std::size_t DocumentView::getGroupCount()
+    {
+        index();
+        return m_groups.size();
+    }
+
+    std::optional<ContentGroup> DocumentView::getGroup(const std::string &label)
+    {
+        TRACE_FUNCTION()
+        const GroupSpan *span = findGroup(label);
+        if (span == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        ContentGroup contentGroup;
+        eosio::datastream<const char *> ds(span->bytes.data(), span->bytes.size());
+        ds >> contentGroup;
+        return contentGroup;
+    }
+
+    ContentGroup DocumentView::getGroupOrFail(const std::string &label, const std::string &error)
+    {
+        TRACE_FUNCTION()
+        auto contentGroup = getGroup(label);
+        if (!contentGroup)
+        {
+            EOS_CHECK(false, error);
+        }
+        return std::move(*contentGroup);
+    }
+
+    ContentGroup DocumentView::getGroupOrFail(const std::string &groupLabel)
+    {
+        TRACE_FUNCTION()
+        auto contentGroup = getGroup(groupLabel);
+        EOS_CHECK(contentGroup.has_value(), "group: " + groupLabel + " is required but not found");
+        return std::move(*contentGroup);
+    }
+
+    std::optional<Content> DocumentView::get(const std::string &groupLabel, const std::string &contentLabel)
+    {
+        TRACE_FUNCTION()
+        const GroupSpan *span = findGroup(groupLabel);
+        if (span == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        RowReader reader{span->bytes.data(), span->bytes.data(), span->bytes.data() + span->bytes.size()};
+        uint32_t itemCount = reader.varint();
+        for (uint32_t i = 0; i < itemCount; ++i)
+        {
+            const char *item = reader.pos;
+            std::string_view label = reader.string();
+            reader.value();
+
+            if (label == contentLabel)
+            {
+                Content content;
+                eosio::datastream<const char *> ds(item, reader.pos - item);
+                ds >> content;
+                return content;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Content DocumentView::getOrFail(const std::string &groupLabel, const std::string &contentLabel, const std::string &error)
+    {
+        TRACE_FUNCTION()
+        auto content = get(groupLabel, contentLabel);
+        if (!content)
+        {
+            EOS_CHECK(false, error);
+        }
+        return std::move(*content);
+    }
+
+    Content DocumentView::getOrFail(const std::string &groupLabel, const std::string &contentLabel)
+    {
+        TRACE_FUNCTION()
+        auto content = get(groupLabel, contentLabel);
+        EOS_CHECK(content.has_value(), "group: " + groupLabel + "; content: " + contentLabel +
+                                           " is required but not found");
+        return std::move(*content);
+    }
+
+    Document DocumentView::toDocument()
+    {
+        TRACE_FUNCTION()
+        return Document(getContract(), m_hash, LoadMode::Trusted);
+    }
+
+} // namespace hypha
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include <document_graph/document.hpp>
 #include <document_graph/edge.hpp>
+#include <document_graph/edge_indexes.hpp>
+#include <document_graph/edge_range.hpp>
+#include <document_graph/state_cache.hpp>
 #include <document_graph/util.hpp>
 #include <logger/logger.hpp>
 
@@ -19,6 +22,216 @@ namespace hypha
 
     Edge::~Edge() {}
 
+    namespace
+    {
+        // the edge from the nodeedges table, if node id mode is on and it is stored there
+        std::optional<Edge> findNodeEdge(const eosio::name &contract,
+                                         const eosio::checksum256 &fromNode,
+                                         const eosio::checksum256 &toNode,
+                                         const eosio::name &edgeName)
+        {
+            if (!Edge::getNodeIdState(contract).enabled)
+            {
+                return std::nullopt;
+            }
+
+            auto fromId = DocumentNode::find(contract, fromNode);
+            auto toId = fromId ? DocumentNode::find(contract, toNode) : std::nullopt;
+            if (!toId)
+            {
+                return std::nullopt;
+            }
+
+            NodeEdge::node_edge_table ne_t(contract, contract.value);
+            auto itr = NodeEdge::find(ne_t, *fromId, *toId, edgeName);
+            if (itr == ne_t.end())
+            {
+                return std::nullopt;
+            }
+            return Edge::fromNodeEdge(contract, *itr);
+        }
+
+        bool edgeExists(const eosio::name &contract,
+                        const eosio::checksum256 &fromNode,
+                        const eosio::checksum256 &toNode,
+                        const eosio::name &edgeName)
+        {
+            if (findNodeEdge(contract, fromNode, toNode, edgeName))
+            {
+                return true;
+            }
+
+            Edge::edge_table e_t(contract, contract.value);
+            return Edge::find(e_t, contract, fromNode, toNode, edgeName) != e_t.end();
+        }
+
+        // stores the edge in the nodeedges table, giving both documents a node if needed
+        uint64_t writeNodeEdge(const eosio::name &contract,
+                               const eosio::name &creator,
+                               const eosio::checksum256 &fromNode,
+                               const eosio::checksum256 &toNode,
+                               const eosio::name &edgeName,
+                               const eosio::time_point &createdDate)
+        {
+            const uint64_t fromId = DocumentNode::getOrNew(contract, fromNode);
+            const uint64_t toId = DocumentNode::getOrNew(contract, toNode);
+
+            NodeEdge::node_edge_table ne_t(contract, contract.value);
+            const uint64_t id = ne_t.available_primary_key();
+            auto itr = ne_t.emplace(contract, [&](auto &e) {
+                e.id = id;
+                e.from_node = fromId;
+                e.to_node = toId;
+                e.edge_name = edgeName;
+                e.created_date = createdDate;
+                e.creator = creator;
+            });
+            EdgeIndexes::adjust(contract, EdgeIndexes::NODE_EDGES, id, fromNode, toNode, edgeName, 1);
+            EdgeTime::write(contract, *itr);
+            return id;
+        }
+    } // namespace
+
+    const EdgeKeyState &Edge::getKeyState(const eosio::name &contract)
+    {
+        return getCachedState<edge_key_singleton, EdgeKeyState>(contract);
+    }
+
+    void Edge::setKeyState(const eosio::name &contract, const EdgeKeyState &state)
+    {
+        setCachedState<edge_key_singleton>(contract, state);
+    }
+
+    const NodeIdState &Edge::getNodeIdState(const eosio::name &contract)
+    {
+        return getCachedState<node_id_singleton, NodeIdState>(contract);
+    }
+
+    void Edge::setNodeIdState(const eosio::name &contract, const NodeIdState &state)
+    {
+        setCachedState<node_id_singleton>(contract, state);
+    }
+
+    const DegreeState &Edge::getDegreeState(const eosio::name &contract)
+    {
+        return getCachedState<degree_singleton, DegreeState>(contract);
+    }
+
+    void Edge::setDegreeState(const eosio::name &contract, const DegreeState &state)
+    {
+        setCachedState<degree_singleton>(contract, state);
+    }
+
+    const EdgeTimeState &Edge::getTimeIndexState(const eosio::name &contract)
+    {
+        return getCachedState<time_index_singleton, EdgeTimeState>(contract);
+    }
+
+    void Edge::setTimeIndexState(const eosio::name &contract, const EdgeTimeState &state)
+    {
+        setCachedState<time_index_singleton>(contract, state);
+    }
+
+    const ClosureState &Edge::getClosureState(const eosio::name &contract)
+    {
+        return getCachedState<closure_singleton, ClosureState>(contract);
+    }
+
+    void Edge::setClosureState(const eosio::name &contract, const ClosureState &state)
+    {
+        setCachedState<closure_singleton>(contract, state);
+    }
+
+    Edge::edge_table::const_iterator Edge::find(const edge_table &e_t,
+                                                const eosio::name &contract,
+                                                const eosio::checksum256 &fromNode,
+                                                const eosio::checksum256 &toNode,
+                                                const eosio::name &edgeName)
+    {
+        if (!getNodeIdState(contract).legacyEdges())
+        {
+            return e_t.end();
+        }
+
+        for (std::uint8_t version : readKeyVersions(contract))
+        {
+            auto itr = e_t.find(idKey(version, fromNode, toNode, edgeName));
+            if (itr != e_t.end())
+            {
+                return itr;
+            }
+        }
+        return e_t.end();
+    }
+
+    Edge Edge::fromNodeEdge(const eosio::name &contract, const NodeEdge &nodeEdge)
+    {
+        return fromNodeEdge(contract, nodeEdge,
+                            DocumentNode::getHash(contract, nodeEdge.from_node),
+                            DocumentNode::getHash(contract, nodeEdge.to_node));
+    }
+
+    Edge Edge::fromNodeEdge(const eosio::name &contract, const NodeEdge &nodeEdge,
+                            const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode)
+    {
+        Edge edge;
+        edge.id = nodeEdge.id;
+        edge.from_node_edge_name_index = 0;
+        edge.from_node_to_node_index = 0;
+        edge.to_node_edge_name_index = 0;
+        edge.from_node = fromNode;
+        edge.to_node = toNode;
+        edge.edge_name = nodeEdge.edge_name;
+        edge.created_date = nodeEdge.created_date;
+        edge.creator = nodeEdge.creator;
+        edge.contract = contract;
+        return edge;
+    }
+
+    std::uint8_t Edge::writeKeyVersion(const eosio::name &contract)
+    {
+        return getKeyState(contract).key_version;
+    }
+
+    EdgeKeyVersions Edge::readKeyVersions(const eosio::name &contract)
+    {
+        const EdgeKeyState &state = getKeyState(contract);
+        if (state.migrating)
+        {
+            return EdgeKeyVersions{{state.key_version, 1}, 2};
+        }
+        return EdgeKeyVersions{{state.key_version, 0}, 1};
+    }
+
+    uint64_t Edge::idKey(std::uint8_t keyVersion, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode, const eosio::name &edgeName)
+    {
+        return keyVersion == 1 ? concatHash(fromNode, toNode, edgeName) : compositeKey(fromNode, toNode, edgeName);
+    }
+
+    uint64_t Edge::fromNameKey(std::uint8_t keyVersion, const eosio::checksum256 &fromNode, const eosio::name &edgeName)
+    {
+        return keyVersion == 1 ? concatHash(fromNode, edgeName) : compositeKey(fromNode, edgeName);
+    }
+
+    uint64_t Edge::fromToKey(std::uint8_t keyVersion, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode)
+    {
+        return keyVersion == 1 ? concatHash(fromNode, toNode) : compositeKey(fromNode, toNode);
+    }
+
+    uint64_t Edge::toNameKey(std::uint8_t keyVersion, const eosio::checksum256 &toNode, const eosio::name &edgeName)
+    {
+        return keyVersion == 1 ? concatHash(toNode, edgeName) : compositeKey(toNode, edgeName);
+    }
+
+    // static
+    void Edge::checkName(const eosio::name &edgeName)
+    {
+        std::string edge_name_str = edgeName.to_string();
+        EOS_CHECK(!edge_name_str.empty(), "Edge name cannot be empty");
+        EOS_CHECK(!isdigit(edge_name_str[0]), "Edge name cannot start with a number");
+        EOS_CHECK(edge_name_str.find('.') == std::string::npos, "Edge name cannot contain '.' characters");
+    }
+
     // static
     void Edge::write(const eosio::name &_contract,
                      const eosio::name &_creator,
@@ -26,27 +239,31 @@ namespace hypha
                      const eosio::checksum256 &_to_node,
                      const eosio::name &_edge_name)
     {
-        edge_table e_t(_contract, _contract.value);
-
-        const int64_t edgeID = concatHash(_from_node, _to_node, _edge_name);
-
         EOS_CHECK(
-          e_t.find(edgeID) == e_t.end(), 
+          !edgeExists(_contract, _from_node, _to_node, _edge_name), 
           util::to_str("Edge from: ", _from_node, 
                        " to: ", _to_node, 
                        " with name: ", _edge_name, " already exists")
         );
-        
-        std::string edge_name_str = _edge_name.to_string();
-        EOS_CHECK(!edge_name_str.empty(), "Edge name cannot be empty");
-        EOS_CHECK(!isdigit(edge_name_str[0]), "Edge name cannot start with a number");
-        EOS_CHECK(edge_name_str.find('.') == std::string::npos, "Edge name cannot contain '.' characters");
+
+        checkName(_edge_name);
+
+        if (getNodeIdState(_contract).enabled)
+        {
+            writeNodeEdge(_contract, _creator, _from_node, _to_node, _edge_name, eosio::current_time_point());
+            return;
+        }
+
+        edge_table e_t(_contract, _contract.value);
+
+        const std::uint8_t keyVersion = writeKeyVersion(_contract);
+        const uint64_t edgeID = idKey(keyVersion, _from_node, _to_node, _edge_name);
 
         e_t.emplace(_contract, [&](auto &e) {
             e.id = edgeID;
-            e.from_node_edge_name_index = concatHash(_from_node, _edge_name);
-            e.from_node_to_node_index = concatHash(_from_node, _to_node);
-            e.to_node_edge_name_index = concatHash(_to_node, _edge_name);
+            e.from_node_edge_name_index = fromNameKey(keyVersion, _from_node, _edge_name);
+            e.from_node_to_node_index = fromToKey(keyVersion, _from_node, _to_node);
+            e.to_node_edge_name_index = toNameKey(keyVersion, _to_node, _edge_name);
             e.creator = _creator;
             e.contract = _contract;
             e.from_node = _from_node;
@@ -54,6 +271,7 @@ namespace hypha
             e.edge_name = _edge_name;
             e.created_date = eosio::current_time_point();
         });
+        EdgeIndexes::adjust(_contract, EdgeIndexes::EDGES, edgeID, _from_node, _to_node, _edge_name, 1);
     }
 
     // static
@@ -63,8 +281,13 @@ namespace hypha
                         const eosio::checksum256 &_to_node,
                         const eosio::name &_edge_name)
     {
+        if (auto edge = findNodeEdge(_contract, _from_node, _to_node, _edge_name))
+        {
+            return *edge;
+        }
+
         edge_table e_t(_contract, _contract.value);
-        auto itr = e_t.find(concatHash(_from_node, _to_node, _edge_name));
+        auto itr = Edge::find(e_t, _contract, _from_node, _to_node, _edge_name);
 
         if (itr != e_t.end())
         {
@@ -80,8 +303,13 @@ namespace hypha
                    const eosio::checksum256 &_to_node,
                    const eosio::name &_edge_name)
     {
+        if (auto edge = findNodeEdge(_contract, _from_node, _to_node, _edge_name))
+        {
+            return *edge;
+        }
+
         edge_table e_t(_contract, _contract.value);
-        auto itr = e_t.find(concatHash(_from_node, _to_node, _edge_name));
+        auto itr = Edge::find(e_t, _contract, _from_node, _to_node, _edge_name);
 
         EOS_CHECK(itr != e_t.end(), "edge does not exist: from " + readableHash(_from_node) + " to " + readableHash(_to_node) + " with edge name of " + _edge_name.to_string());
 
@@ -93,14 +321,11 @@ namespace hypha
                    const eosio::checksum256 &_from_node,
                    const eosio::name &_edge_name)
     {
-        edge_table e_t(_contract, _contract.value);
-        auto fromEdgeIndex = e_t.get_index<eosio::name("byfromname")>();
-        auto index = concatHash(_from_node, _edge_name);
-        auto itr = fromEdgeIndex.find(index);
+        auto [exists, edge] = getIfExists(_contract, _from_node, _edge_name);
 
-        EOS_CHECK(itr != fromEdgeIndex.end() && itr->from_node_edge_name_index == index, "edge does not exist: from " + readableHash(_from_node) + " with edge name of " + _edge_name.to_string());
+        EOS_CHECK(exists, "edge does not exist: from " + readableHash(_from_node) + " with edge name of " + _edge_name.to_string());
 
-        return *itr;
+        return edge;
     }
 
     // static getter
@@ -108,14 +333,11 @@ namespace hypha
                      const eosio::checksum256 &_to_node,
                      const eosio::name &_edge_name)
     {
-        edge_table e_t(_contract, _contract.value);
-        auto toEdgeIndex = e_t.get_index<eosio::name("bytoname")>();
-        auto index = concatHash(_to_node, _edge_name);
-        auto itr = toEdgeIndex.find(index);
+        std::optional<Edge> edge = EdgeRange::to(_contract, _to_node, _edge_name).first();
 
-        EOS_CHECK(itr != toEdgeIndex.end() && itr->to_node_edge_name_index == index, "edge does not exist: to " + readableHash(_to_node) + " with edge name of " + _edge_name.to_string());
+        EOS_CHECK(edge.has_value(), "edge does not exist: to " + readableHash(_to_node) + " with edge name of " + _edge_name.to_string());
 
-        return *itr;
+        return *edge;
     }
 
     // static getter
@@ -123,17 +345,8 @@ namespace hypha
                                             const eosio::checksum256 &_from_node,
                                             const eosio::name &_edge_name)
     {
-        edge_table e_t(_contract, _contract.value);
-        auto fromEdgeIndex = e_t.get_index<eosio::name("byfromname")>();
-        auto index = concatHash(_from_node, _edge_name);
-        auto itr = fromEdgeIndex.find(index);
-
-        if (itr != fromEdgeIndex.end() && itr->from_node_edge_name_index == index)
-        {
-            return std::pair<bool, Edge> (true, *itr);
-        }
-
-        return std::pair<bool, Edge>(false, Edge{});
+        std::optional<Edge> edge = EdgeRange::from(_contract, _from_node, _edge_name).first();
+        return std::pair<bool, Edge>(edge.has_value(), edge.value_or(Edge{}));
     }
 
     // static getter
@@ -142,26 +355,37 @@ namespace hypha
                       const eosio::checksum256 &_to_node,
                       const eosio::name &_edge_name)
     {
-        edge_table e_t(_contract, _contract.value);
-        auto itr = e_t.find(concatHash(_from_node, _to_node, _edge_name));
-        if (itr != e_t.end())
-            return true;
-        return false;
+        return edgeExists(_contract, _from_node, _to_node, _edge_name);
     }
 
     void Edge::emplace()
     {
+        if (getNodeIdState(getContract()).enabled)
+        {
+            EOS_CHECK(
+              !edgeExists(getContract(), from_node, to_node, edge_name), 
+              util::to_str("Edge from: ", from_node, 
+                           " to: ", to_node, 
+                           " with name: ", edge_name, " already exists")
+            );
+
+            created_date = eosio::current_time_point();
+            id = writeNodeEdge(getContract(), creator, from_node, to_node, edge_name, created_date);
+            return;
+        }
+
         // update indexes prior to save
-        id = concatHash(from_node, to_node, edge_name);
+        const std::uint8_t keyVersion = writeKeyVersion(getContract());
+        id = idKey(keyVersion, from_node, to_node, edge_name);
 
-        from_node_edge_name_index = concatHash(from_node, edge_name);
-        from_node_to_node_index = concatHash(from_node, to_node);
-        to_node_edge_name_index = concatHash(to_node, edge_name);
+        from_node_edge_name_index = fromNameKey(keyVersion, from_node, edge_name);
+        from_node_to_node_index = fromToKey(keyVersion, from_node, to_node);
+        to_node_edge_name_index = toNameKey(keyVersion, to_node, edge_name);
 
         edge_table e_t(getContract(), getContract().value);
 
         EOS_CHECK(
-          e_t.find(id) == e_t.end(), 
+          Edge::find(e_t, getContract(), from_node, to_node, edge_name) == e_t.end(), 
           util::to_str("Edge from: ", from_node, 
                        " to: ", to_node, 
                        " with name: ", edge_name, " already exists")
@@ -171,14 +395,37 @@ namespace hypha
             e = *this;
             e.created_date = eosio::current_time_point();
         });
+        EdgeIndexes::adjust(getContract(), *this, 1);
     }
 
     void Edge::erase()
     {
+        if (getNodeIdState(getContract()).enabled)
+        {
+            auto fromId = DocumentNode::find(getContract(), from_node);
+            auto toId = fromId ? DocumentNode::find(getContract(), to_node) : std::nullopt;
+            if (toId)
+            {
+                NodeEdge::node_edge_table ne_t(getContract(), getContract().value);
+                auto itr = NodeEdge::find(ne_t, *fromId, *toId, edge_name);
+                if (itr != ne_t.end())
+                {
+                    EdgeIndexes::adjust(getContract(), EdgeIndexes::NODE_EDGES, itr->id, from_node, to_node, edge_name, -1);
+                    EdgeTime::remove(getContract(), itr->id);
+                    ne_t.erase(itr);
+                    return;
+                }
+            }
+        }
+
         edge_table e_t(getContract(), getContract().value);
         auto itr = e_t.find(id);
 
-        EOS_CHECK(itr != e_t.end(), "edge does not exist: from " + readableHash(from_node) + " to " + readableHash(to_node) + " with edge name of " + edge_name.to_string());
+        // ids of the two tables overlap, so make sure this is the same edge
+        EOS_CHECK(getNodeIdState(getContract()).legacyEdges() && itr != e_t.end() &&
+                  itr->from_node == from_node && itr->to_node == to_node && itr->edge_name == edge_name,
+                  "edge does not exist: from " + readableHash(from_node) + " to " + readableHash(to_node) + " with edge name of " + edge_name.to_string());
+        EdgeIndexes::adjust(getContract(), *itr, -1);
         e_t.erase(itr);
     }
 
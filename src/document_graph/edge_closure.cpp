@@ -0,0 +1,228 @@
+#include <array>
+#include <cstring>
+#include <set>
+
+#include <document_graph/edge_closure.hpp>
+#include <document_graph/edge.hpp>
+#include <document_graph/util.hpp>
+#include <logger/logger.hpp>
+
+namespace hypha
+{
+    namespace
+    {
+        Ancestry::ancestry_table::const_iterator findPair(const Ancestry::ancestry_table &a_t,
+                                                          const eosio::checksum256 &ancestor,
+                                                          const eosio::checksum256 &descendant,
+                                                          const eosio::name &edgeName)
+        {
+            auto pair_index = a_t.get_index<eosio::name("bypair")>();
+            auto itr = pair_index.find(Ancestry::pairKey(ancestor, descendant, edgeName));
+            if (itr == pair_index.end() || itr->ancestor != ancestor || itr->descendant != descendant || itr->edge_name != edgeName)
+            {
+                return a_t.end();
+            }
+            return a_t.iterator_to(*itr);
+        }
+
+        // adds or subtracts paths on the row of one pair, creating it or erasing it at zero
+        void addPaths(Ancestry::ancestry_table &a_t, const eosio::name &contract,
+                      const eosio::checksum256 &ancestor, const eosio::checksum256 &descendant,
+                      const eosio::name &edgeName, int64_t delta, uint64_t paths)
+        {
+            auto itr = findPair(a_t, ancestor, descendant, edgeName);
+            if (itr == a_t.end())
+            {
+                EOS_CHECK(delta > 0, "ancestry of " + readableHash(descendant) + " by " + edgeName.to_string() + " edges is missing " + readableHash(ancestor));
+                const uint64_t id = a_t.available_primary_key();
+                a_t.emplace(contract, [&](auto &a) {
+                    a.id = id;
+                    a.ancestor = ancestor;
+                    a.descendant = descendant;
+                    a.edge_name = edgeName;
+                    a.paths = paths;
+                    a.pair_key = Ancestry::pairKey(ancestor, descendant, edgeName);
+                });
+                return;
+            }
+
+            if (delta > 0)
+            {
+                EOS_CHECK(itr->paths <= std::numeric_limits<uint64_t>::max() - paths, "too many " + edgeName.to_string() + " paths to count");
+                a_t.modify(itr, contract, [&](auto &a) {
+                    a.paths += paths;
+                });
+                return;
+            }
+
+            EOS_CHECK(itr->paths >= paths, "ancestry of " + readableHash(descendant) + " by " + edgeName.to_string() + " edges has fewer paths than removed");
+            if (itr->paths == paths)
+            {
+                a_t.erase(itr);
+                return;
+            }
+            a_t.modify(itr, contract, [&](auto &a) {
+                a.paths -= paths;
+            });
+        }
+    } // namespace
+
+    const ClosureConfig *ClosureState::find(const eosio::name &edgeName) const
+    {
+        for (const ClosureConfig &config : configs)
+        {
+            if (config.edge_name == edgeName)
+            {
+                return &config;
+            }
+        }
+        return nullptr;
+    }
+
+    ClosureConfig *ClosureState::find(const eosio::name &edgeName)
+    {
+        return const_cast<ClosureConfig *>(static_cast<const ClosureState *>(this)->find(edgeName));
+    }
+
+    eosio::checksum256 Ancestry::pairKey(const eosio::checksum256 &ancestor, const eosio::checksum256 &descendant, const eosio::name &edgeName)
+    {
+        std::array<char, 72> bytes;
+        const auto a = ancestor.extract_as_byte_array();
+        const auto d = descendant.extract_as_byte_array();
+        std::memcpy(bytes.data(), a.data(), 32);
+        std::memcpy(bytes.data() + 32, d.data(), 32);
+        std::memcpy(bytes.data() + 64, &edgeName.value, 8);
+        return eosio::sha256(bytes.data(), bytes.size());
+    }
+
+    bool EdgeClosure::isAncestor(const eosio::name &contract, const eosio::checksum256 &ancestor,
+                                 const eosio::checksum256 &descendant, const eosio::name &edgeName)
+    {
+        const ClosureConfig *config = Edge::getClosureState(contract).find(edgeName);
+        EOS_CHECK(config && !config->building, "no ancestry closure is built for edge name " + edgeName.to_string());
+
+        Ancestry::ancestry_table a_t(contract, contract.value);
+        return findPair(a_t, ancestor, descendant, edgeName) != a_t.end();
+    }
+
+    bool EdgeClosure::includes(const eosio::name &contract, const eosio::name &edgeName, std::uint8_t source, uint64_t id)
+    {
+        const ClosureConfig *config = Edge::getClosureState(contract).find(edgeName);
+        return config && config->includes(source, id);
+    }
+
+    void EdgeClosure::adjust(const eosio::name &contract, std::uint8_t source, uint64_t id,
+                             const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                             const eosio::name &edgeName, int64_t delta)
+    {
+        const ClosureConfig *config = Edge::getClosureState(contract).find(edgeName);
+        if (config && config->includes(source, id))
+        {
+            apply(contract, *config, fromNode, toNode, delta);
+        }
+    }
+
+    // Every ancestor of fromNode gains (or loses) a path to every descendant of toNode, counted
+    // as the product of the paths on both sides. A removal finds the same ancestors and
+    // descendants its write did, as no acyclic path to fromNode or from toNode uses the edge.
+    void EdgeClosure::apply(const eosio::name &contract, const ClosureConfig &config,
+                            const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode, int64_t delta)
+    {
+        const eosio::name &edgeName = config.edge_name;
+        Ancestry::ancestry_table a_t(contract, contract.value);
+
+        if (delta > 0)
+        {
+            EOS_CHECK(fromNode != toNode && findPair(a_t, toNode, fromNode, edgeName) == a_t.end(),
+                      "edge from " + readableHash(fromNode) + " to " + readableHash(toNode) + " would close a cycle of " + edgeName.to_string() + " edges");
+        }
+
+        // each node is also joined to itself by the empty path
+        std::vector<std::pair<eosio::checksum256, uint64_t>> ancestors{{fromNode, 1}};
+        auto desc_index = a_t.get_index<eosio::name("bydesc")>();
+        for (auto itr = desc_index.find(fromNode); itr != desc_index.end() && itr->descendant == fromNode; ++itr)
+        {
+            if (itr->edge_name == edgeName)
+            {
+                ancestors.emplace_back(itr->ancestor, itr->paths);
+            }
+        }
+
+        std::vector<std::pair<eosio::checksum256, uint64_t>> descendants{{toNode, 1}};
+        auto ancestor_index = a_t.get_index<eosio::name("byancestor")>();
+        for (auto itr = ancestor_index.find(toNode); itr != ancestor_index.end() && itr->ancestor == toNode; ++itr)
+        {
+            if (itr->edge_name == edgeName)
+            {
+                descendants.emplace_back(itr->descendant, itr->paths);
+            }
+        }
+
+        // removals are never refused, even if the bound was lowered since the write
+        const uint64_t updates = ancestors.size() * descendants.size();
+        EOS_CHECK(delta < 0 || updates <= config.max_updates,
+                  "edge from " + readableHash(fromNode) + " to " + readableHash(toNode) + " would change " + std::to_string(updates) +
+                      " " + edgeName.to_string() + " ancestry rows, more than " + std::to_string(config.max_updates));
+
+        for (const auto &ancestor : ancestors)
+        {
+            for (const auto &descendant : descendants)
+            {
+                EOS_CHECK(ancestor.second <= std::numeric_limits<uint64_t>::max() / descendant.second,
+                          "too many " + edgeName.to_string() + " paths to count");
+                addPaths(a_t, contract, ancestor.first, descendant.first, edgeName, delta, ancestor.second * descendant.second);
+            }
+        }
+    }
+
+    void EdgeClosure::renameNode(const eosio::name &contract, const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode)
+    {
+        if (Edge::getClosureState(contract).configs.empty())
+        {
+            return;
+        }
+
+        Ancestry::ancestry_table a_t(contract, contract.value);
+        auto ancestor_index = a_t.get_index<eosio::name("byancestor")>();
+        auto desc_index = a_t.get_index<eosio::name("bydesc")>();
+
+        std::set<uint64_t> newNames;
+        for (auto itr = ancestor_index.find(newNode); itr != ancestor_index.end() && itr->ancestor == newNode; ++itr)
+        {
+            newNames.insert(itr->edge_name.value);
+        }
+        for (auto itr = desc_index.find(newNode); itr != desc_index.end() && itr->descendant == newNode; ++itr)
+        {
+            newNames.insert(itr->edge_name.value);
+        }
+
+        // collect first: the rows move out of the ranges being walked
+        std::vector<uint64_t> ids;
+        for (auto itr = ancestor_index.find(oldNode); itr != ancestor_index.end() && itr->ancestor == oldNode; ++itr)
+        {
+            ids.push_back(itr->id);
+        }
+        for (auto itr = desc_index.find(oldNode); itr != desc_index.end() && itr->descendant == oldNode; ++itr)
+        {
+            ids.push_back(itr->id);
+        }
+
+        for (uint64_t id : ids)
+        {
+            auto itr = a_t.find(id);
+            EOS_CHECK(newNames.count(itr->edge_name.value) == 0,
+                      "cannot merge the " + itr->edge_name.to_string() + " ancestry of " + readableHash(oldNode) + " into " + readableHash(newNode));
+            a_t.modify(itr, contract, [&](auto &a) {
+                if (a.ancestor == oldNode)
+                {
+                    a.ancestor = newNode;
+                }
+                if (a.descendant == oldNode)
+                {
+                    a.descendant = newNode;
+                }
+                a.pair_key = Ancestry::pairKey(a.ancestor, a.descendant, a.edge_name);
+            });
+        }
+    }
+} // namespace hypha
\ No newline at end of file
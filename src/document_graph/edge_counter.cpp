@@ -0,0 +1,106 @@
+#include <document_graph/edge_counter.hpp>
+#include <document_graph/edge.hpp>
+#include <document_graph/util.hpp>
+#include <logger/logger.hpp>
+
+namespace hypha
+{
+    namespace
+    {
+        EdgeCounter::counter_table::const_iterator findCounter(const EdgeCounter::counter_table &c_t,
+                                                               const eosio::checksum256 &node,
+                                                               const eosio::name &edgeName,
+                                                               EdgeDirection direction)
+        {
+            auto node_name_index = c_t.get_index<eosio::name("bynodename")>();
+            const uint64_t key = compositeKey(node, edgeName);
+            for (auto itr = node_name_index.find(key); itr != node_name_index.end() && itr->by_node_name() == key; ++itr)
+            {
+                // the composite key can collide, so confirm the row really matches
+                if (itr->node == node && itr->edge_name == edgeName && itr->direction == static_cast<std::uint8_t>(direction))
+                {
+                    return c_t.iterator_to(*itr);
+                }
+            }
+            return c_t.end();
+        }
+    } // namespace
+
+    uint64_t EdgeCounter::by_node_name() const { return compositeKey(node, edge_name); }
+
+    uint64_t EdgeCounter::get(const eosio::name &contract, const eosio::checksum256 &node,
+                              const eosio::name &edgeName, EdgeDirection direction)
+    {
+        counter_table c_t(contract, contract.value);
+        auto itr = findCounter(c_t, node, edgeName, direction);
+        return itr == c_t.end() ? 0 : itr->count;
+    }
+
+    void EdgeCounter::add(counter_table &c_t, const eosio::name &contract, const eosio::checksum256 &node,
+                          const eosio::name &edgeName, EdgeDirection direction, int64_t delta)
+    {
+        auto itr = findCounter(c_t, node, edgeName, direction);
+        if (itr == c_t.end())
+        {
+            EOS_CHECK(delta > 0, "edge counter of " + readableHash(node) + " with name " + edgeName.to_string() + " would become negative");
+            const uint64_t id = c_t.available_primary_key();
+            c_t.emplace(contract, [&](auto &c) {
+                c.id = id;
+                c.node = node;
+                c.edge_name = edgeName;
+                c.direction = static_cast<std::uint8_t>(direction);
+                c.count = delta;
+            });
+            return;
+        }
+
+        EOS_CHECK(delta >= 0 || itr->count >= static_cast<uint64_t>(-delta),
+                  "edge counter of " + readableHash(node) + " with name " + edgeName.to_string() + " would become negative");
+        if (itr->count + delta == 0)
+        {
+            c_t.erase(itr);
+            return;
+        }
+        c_t.modify(itr, contract, [&](auto &c) {
+            c.count += delta;
+        });
+    }
+
+    void EdgeCounter::adjust(const eosio::name &contract, std::uint8_t source, uint64_t id,
+                             const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                             const eosio::name &edgeName, int64_t delta)
+    {
+        if (!Edge::getDegreeState(contract).counts(source, id))
+        {
+            return;
+        }
+
+        counter_table c_t(contract, contract.value);
+        add(c_t, contract, fromNode, edgeName, EdgeDirection::Out, delta);
+        add(c_t, contract, toNode, edgeName, EdgeDirection::In, delta);
+    }
+
+    void EdgeCounter::moveNode(const eosio::name &contract, const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode)
+    {
+        if (!Edge::getDegreeState(contract).enabled)
+        {
+            return;
+        }
+
+        counter_table c_t(contract, contract.value);
+        auto node_index = c_t.get_index<eosio::name("bynode")>();
+
+        std::vector<EdgeCounter> counters;
+        auto itr = node_index.find(oldNode);
+        while (itr != node_index.end() && itr->node == oldNode)
+        {
+            counters.push_back(*itr);
+            itr = node_index.erase(itr);
+        }
+
+        for (const EdgeCounter &counter : counters)
+        {
+            add(c_t, contract, newNode, counter.edge_name, static_cast<EdgeDirection>(counter.direction), counter.count);
+        }
+    }
+} // namespace hypha
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include <document_graph/edge_indexes.hpp>
+#include <document_graph/edge.hpp>
+
+namespace hypha
+{
+    void EdgeIndexes::adjust(const eosio::name &contract, std::uint8_t source, uint64_t id,
+                             const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode,
+                             const eosio::name &edgeName, int64_t delta)
+    {
+        EdgeCounter::adjust(contract, source, id, fromNode, toNode, edgeName, delta);
+        EdgeClosure::adjust(contract, source, id, fromNode, toNode, edgeName, delta);
+    }
+
+    void EdgeIndexes::adjust(const eosio::name &contract, const Edge &edge, int64_t delta)
+    {
+        adjust(contract, EDGES, edge.id, edge.from_node, edge.to_node, edge.edge_name, delta);
+    }
+
+    void EdgeIndexes::adjust(const eosio::name &contract, const NodeEdge &nodeEdge, int64_t delta)
+    {
+        // resolve the hashes only for rows an index includes
+        if (Edge::getDegreeState(contract).counts(NODE_EDGES, nodeEdge.id) ||
+            EdgeClosure::includes(contract, nodeEdge.edge_name, NODE_EDGES, nodeEdge.id))
+        {
+            adjust(contract, NODE_EDGES, nodeEdge.id,
+                   DocumentNode::getHash(contract, nodeEdge.from_node),
+                   DocumentNode::getHash(contract, nodeEdge.to_node),
+                   nodeEdge.edge_name, delta);
+        }
+    }
+
+    void EdgeIndexes::renameNode(const eosio::name &contract, const eosio::checksum256 &oldNode, const eosio::checksum256 &newNode)
+    {
+        EdgeCounter::moveNode(contract, oldNode, newNode);
+        EdgeClosure::renameNode(contract, oldNode, newNode);
+    }
+} // namespace hypha
\ No newline at end of file
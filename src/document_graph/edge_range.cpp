@@ -0,0 +1,272 @@
+#include <document_graph/edge_range.hpp>
+#include <document_graph/util.hpp>
+#include <logger/logger.hpp>
+
+namespace hypha
+{
+    namespace
+    {
+        // Walks the rows stored under key in one index, after the cursor row when there is one.
+        // Rows sharing a key are ordered by primary key, so a cursor row still under key is
+        // resumed from directly; otherwise the rows up to it are skipped. Every row read, skipped
+        // or not, is added to rows. step returns false to stop; so does this function.
+        template <typename Table, typename Index, typename Key, typename KeyOf, typename Step>
+        bool walkIndex(const Table &table, const Index &index, const Key &key, KeyOf keyOf,
+                       const std::optional<uint64_t> &afterId, uint64_t &rows, Step step)
+        {
+            auto itr = index.find(key);
+            if (afterId)
+            {
+                auto last = table.find(*afterId);
+                if (last != table.end() && keyOf(*last) == key)
+                {
+                    itr = ++index.iterator_to(*last);
+                }
+            }
+
+            for (; itr != index.end() && keyOf(*itr) == key; ++itr)
+            {
+                rows++;
+                if (afterId && itr->primary_key() <= *afterId)
+                {
+                    continue;
+                }
+                if (!step(*itr))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    eosio::checksum256 EdgeRef::getFromNode() const
+    {
+        if (m_edge)
+        {
+            return m_edge->from_node;
+        }
+        return m_fromNode ? *m_fromNode : DocumentNode::getHash(m_contract, m_nodeEdge->from_node);
+    }
+
+    eosio::checksum256 EdgeRef::getToNode() const
+    {
+        if (m_edge)
+        {
+            return m_edge->to_node;
+        }
+        return m_toNode ? *m_toNode : DocumentNode::getHash(m_contract, m_nodeEdge->to_node);
+    }
+
+    Edge EdgeRef::toEdge() const
+    {
+        if (m_edge)
+        {
+            return *m_edge;
+        }
+
+        return Edge::fromNodeEdge(m_contract, *m_nodeEdge, getFromNode(), getToNode());
+    }
+
+    EdgeRange::EdgeRange(Kind kind, const eosio::name &contract, const eosio::checksum256 &node,
+                         const eosio::checksum256 &toNode, const eosio::name &edgeName)
+        : m_kind(kind), m_contract(contract), m_node(node), m_toNode(toNode), m_edgeName(edgeName)
+    {
+    }
+
+    EdgeRange EdgeRange::from(const eosio::name &contract, const eosio::checksum256 &fromNode, const eosio::name &edgeName)
+    {
+        return EdgeRange(Kind::From, contract, fromNode, eosio::checksum256(), edgeName);
+    }
+
+    EdgeRange EdgeRange::to(const eosio::name &contract, const eosio::checksum256 &toNode, const eosio::name &edgeName)
+    {
+        return EdgeRange(Kind::To, contract, toNode, eosio::checksum256(), edgeName);
+    }
+
+    EdgeRange EdgeRange::between(const eosio::name &contract, const eosio::checksum256 &fromNode, const eosio::checksum256 &toNode)
+    {
+        return EdgeRange(Kind::Between, contract, fromNode, toNode, eosio::name());
+    }
+
+    EdgeRange &EdgeRange::limit(uint64_t count)
+    {
+        m_limit = count;
+        return *this;
+    }
+
+    EdgeRange &EdgeRange::after(const EdgeCursor &cursor)
+    {
+        m_cursor = cursor;
+        return *this;
+    }
+
+    bool EdgeRange::matches(const Edge &edge) const
+    {
+        switch (m_kind)
+        {
+        case Kind::From:
+            return edge.from_node == m_node && edge.edge_name == m_edgeName;
+        case Kind::To:
+            return edge.to_node == m_node && edge.edge_name == m_edgeName;
+        default:
+            return edge.from_node == m_node && edge.to_node == m_toNode;
+        }
+    }
+
+    EdgeCursor EdgeRange::visit(const std::function<bool(const EdgeRef &)> &visitor) const
+    {
+        uint64_t rowsRead = 0;
+        return visit(visitor, rowsRead);
+    }
+
+    EdgeCursor EdgeRange::visit(const std::function<bool(const EdgeRef &)> &visitor, uint64_t &rowsRead) const
+    {
+        TRACE_FUNCTION()
+        EdgeCursor cursor = m_cursor;
+        if (cursor.done || m_limit == 0)
+        {
+            return cursor;
+        }
+
+        // sources before the cursor's one were finished by the earlier walk
+        bool seeking = cursor.started;
+        auto afterId = [&](std::uint8_t source) -> std::optional<uint64_t> {
+            if (seeking && source == cursor.source)
+            {
+                seeking = false;
+                return cursor.last_id;
+            }
+            return std::nullopt;
+        };
+
+        uint64_t visited = 0;
+        auto step = [&](std::uint8_t source, uint64_t id, const EdgeRef &edge) {
+            cursor.source = source;
+            cursor.last_id = id;
+            cursor.started = true;
+            return visitor(edge) && ++visited < m_limit;
+        };
+
+        const NodeIdState &nodeIds = Edge::getNodeIdState(m_contract);
+        if (nodeIds.enabled)
+        {
+            const std::optional<uint64_t> after = afterId(0);
+            if (!seeking)
+            {
+                NodeEdge::node_edge_table ne_t(m_contract, m_contract.value);
+                // the hashes this range already knows
+                const eosio::checksum256 *fromNode = m_kind == Kind::To ? nullptr : &m_node;
+                const eosio::checksum256 *toNode = m_kind == Kind::To ? &m_node : (m_kind == Kind::Between ? &m_toNode : nullptr);
+                auto nodeStep = [&](const NodeEdge &row) {
+                    return step(0, row.id, EdgeRef(m_contract, row, fromNode, toNode));
+                };
+
+                bool more = true;
+                if (auto id = DocumentNode::find(m_contract, m_node))
+                {
+                    if (m_kind == Kind::From)
+                    {
+                        more = walkIndex(ne_t, ne_t.get_index<eosio::name("byfromname")>(), NodeEdge::nodeKey(*id, m_edgeName.value),
+                                         [](const NodeEdge &e) { return e.by_from_node_edge_name(); }, after, rowsRead, nodeStep);
+                    }
+                    else if (m_kind == Kind::To)
+                    {
+                        more = walkIndex(ne_t, ne_t.get_index<eosio::name("bytoname")>(), NodeEdge::nodeKey(*id, m_edgeName.value),
+                                         [](const NodeEdge &e) { return e.by_to_node_edge_name(); }, after, rowsRead, nodeStep);
+                    }
+                    else if (auto toId = DocumentNode::find(m_contract, m_toNode))
+                    {
+                        more = walkIndex(ne_t, ne_t.get_index<eosio::name("byfromto")>(), NodeEdge::nodeKey(*id, *toId),
+                                         [](const NodeEdge &e) { return e.by_from_node_to_node(); }, after, rowsRead, nodeStep);
+                    }
+                }
+                if (!more)
+                {
+                    return cursor;
+                }
+            }
+        }
+
+        if (nodeIds.legacyEdges())
+        {
+            Edge::edge_table e_t(m_contract, m_contract.value);
+            for (std::uint8_t version : Edge::readKeyVersions(m_contract))
+            {
+                const std::optional<uint64_t> after = afterId(version);
+                if (seeking)
+                {
+                    continue;
+                }
+
+                auto legacyStep = [&](const Edge &row) {
+                    return !matches(row) || step(version, row.id, EdgeRef(m_contract, row));
+                };
+
+                bool more;
+                if (m_kind == Kind::From)
+                {
+                    more = walkIndex(e_t, e_t.get_index<eosio::name("byfromname")>(), Edge::fromNameKey(version, m_node, m_edgeName),
+                                     [](const Edge &e) { return e.by_from_node_edge_name_index(); }, after, rowsRead, legacyStep);
+                }
+                else if (m_kind == Kind::To)
+                {
+                    more = walkIndex(e_t, e_t.get_index<eosio::name("bytoname")>(), Edge::toNameKey(version, m_node, m_edgeName),
+                                     [](const Edge &e) { return e.by_to_node_edge_name_index(); }, after, rowsRead, legacyStep);
+                }
+                else
+                {
+                    more = walkIndex(e_t, e_t.get_index<eosio::name("byfromto")>(), Edge::fromToKey(version, m_node, m_toNode),
+                                     [](const Edge &e) { return e.by_from_node_to_node_index(); }, after, rowsRead, legacyStep);
+                }
+                if (!more)
+                {
+                    return cursor;
+                }
+            }
+        }
+
+        cursor.done = true;
+        return cursor;
+    }
+
+    bool EdgeRange::empty() const
+    {
+        bool found = false;
+        visit([&](const EdgeRef &) {
+            found = true;
+            return false;
+        });
+        return !found;
+    }
+
+    std::optional<Edge> EdgeRange::first() const
+    {
+        std::optional<Edge> edge;
+        visit([&](const EdgeRef &ref) {
+            edge = ref.toEdge();
+            return false;
+        });
+        return edge;
+    }
+
+    uint64_t EdgeRange::count() const
+    {
+        uint64_t count = 0;
+        visit([&](const EdgeRef &) {
+            count++;
+            return true;
+        });
+        return count;
+    }
+
+    std::vector<Edge> EdgeRange::toVector() const
+    {
+        std::vector<Edge> edges;
+        visit([&](const EdgeRef &ref) {
+            edges.push_back(ref.toEdge());
+            return true;
+        });
+        return edges;
+    }
+} // namespace hypha
\ No newline at end of file
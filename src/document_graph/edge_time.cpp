@@ -0,0 +1,55 @@
+#include <document_graph/edge_time.hpp>
+#include <document_graph/edge.hpp>
+
+namespace hypha
+{
+    eosio::checksum256 EdgeTime::timeKey(uint64_t node, const eosio::name &edgeName, const eosio::time_point &created, uint64_t id)
+    {
+        // idx256 keys compare as two uint128 words, most significant first
+        return eosio::checksum256(std::array<uint128_t, 2>{
+            (uint128_t(node) << 64) | edgeName.value,
+            (uint128_t(created.time_since_epoch().count()) << 64) | id});
+    }
+
+    void EdgeTime::write(const eosio::name &contract, const NodeEdge &nodeEdge)
+    {
+        if (!Edge::getTimeIndexState(contract).indexes(nodeEdge.id))
+        {
+            return;
+        }
+
+        auto assign = [&](auto &t) {
+            t.id = nodeEdge.id;
+            t.from_node = nodeEdge.from_node;
+            t.to_node = nodeEdge.to_node;
+            t.edge_name = nodeEdge.edge_name;
+            t.created_date = nodeEdge.created_date;
+        };
+
+        time_table t_t(contract, contract.value);
+        auto itr = t_t.find(nodeEdge.id);
+        if (itr == t_t.end())
+        {
+            t_t.emplace(contract, assign);
+        }
+        else
+        {
+            t_t.modify(itr, contract, assign);
+        }
+    }
+
+    void EdgeTime::remove(const eosio::name &contract, uint64_t id)
+    {
+        if (!Edge::getTimeIndexState(contract).indexes(id))
+        {
+            return;
+        }
+
+        time_table t_t(contract, contract.value);
+        auto itr = t_t.find(id);
+        if (itr != t_t.end())
+        {
+            t_t.erase(itr);
+        }
+    }
+} // namespace hypha
\ No newline at end of file
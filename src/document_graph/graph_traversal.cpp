@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <deque>
+#include <map>
+
+#include <document_graph/graph_traversal.hpp>
+#include <logger/logger.hpp>
+
+namespace hypha
+{
+    TraversalToken GraphTraversal::start(const eosio::checksum256 &node)
+    {
+        TraversalToken token;
+        TraversalFrame frame;
+        frame.node = node;
+        token.frontier.push_back(frame);
+        token.visited.emplace_back(node, 0);
+        return token;
+    }
+
+    void GraphTraversal::run(const eosio::name &contract, TraversalToken &token,
+                             const TraversalSpec &spec, const TraversalVisitor &visitor)
+    {
+        TRACE_FUNCTION()
+        EOS_CHECK(!spec.edge_names.empty(), "a traversal needs the edge names to follow");
+        if (token.done)
+        {
+            return;
+        }
+
+        std::map<eosio::checksum256, uint32_t> visited(token.visited.begin(), token.visited.end());
+        std::deque<TraversalFrame> frontier(token.frontier.begin(), token.frontier.end());
+        uint64_t budget = spec.budget;
+        bool stopped = visited.size() >= spec.max_visited;
+
+        while (!stopped)
+        {
+            if (!token.current)
+            {
+                if (frontier.empty())
+                {
+                    break;
+                }
+
+                if (spec.order == TraversalOrder::BreadthFirst)
+                {
+                    token.current = frontier.front();
+                    frontier.pop_front();
+                }
+                else
+                {
+                    token.current = frontier.back();
+                    frontier.pop_back();
+                }
+
+                // reached over fewer hops since it was queued, so queued again with that depth
+                if (token.current->depth > visited[token.current->node])
+                {
+                    token.current.reset();
+                    continue;
+                }
+            }
+
+            TraversalFrame &frame = *token.current;
+            const std::vector<eosio::name> &names = spec.edge_names[std::min<size_t>(frame.depth, spec.edge_names.size() - 1)];
+
+            while (frame.depth < spec.max_depth && frame.name_index < names.size() && budget > 0)
+            {
+                EdgeRange range = spec.direction == EdgeDirection::Out
+                                      ? EdgeRange::from(contract, frame.node, names[frame.name_index])
+                                      : EdgeRange::to(contract, frame.node, names[frame.name_index]);
+
+                // rows skipped to resume the cursor count against the budget as well
+                uint64_t read = 0;
+                frame.cursor = range.limit(budget).after(frame.cursor).visit([&](const EdgeRef &edge) {
+                    const eosio::checksum256 next = spec.direction == EdgeDirection::Out ? edge.getToNode() : edge.getFromNode();
+                    auto [itr, inserted] = visited.emplace(next, frame.depth + 1);
+                    if (!inserted)
+                    {
+                        // only depth-first order reaches a node over fewer hops than before
+                        if (itr->second <= frame.depth + 1)
+                        {
+                            return true;
+                        }
+                        itr->second = frame.depth + 1;
+                    }
+
+                    if (!visitor(next, frame.depth + 1, edge) || visited.size() >= spec.max_visited)
+                    {
+                        stopped = true;
+                        return false;
+                    }
+
+                    // nodes at the maximum depth are reported but not expanded
+                    if (frame.depth + 1 < spec.max_depth)
+                    {
+                        TraversalFrame child;
+                        child.node = next;
+                        child.depth = frame.depth + 1;
+                        frontier.push_back(child);
+                    }
+                    return true;
+                }, read);
+
+                budget -= std::min(budget, read);
+                token.edges_read += read;
+                if (stopped || !frame.cursor.done)
+                {
+                    break;
+                }
+
+                frame.name_index++;
+                frame.cursor = EdgeCursor();
+            }
+
+            if (!stopped && frame.depth < spec.max_depth && frame.name_index < names.size())
+            {
+                // out of budget part way through the node
+                break;
+            }
+            token.current.reset();
+        }
+
+        token.done = stopped || (!token.current && frontier.empty());
+        token.frontier.assign(frontier.begin(), frontier.end());
+        token.visited.assign(visited.begin(), visited.end());
+    }
+
+    std::optional<std::vector<Edge>> GraphTraversal::findPath(const eosio::name &contract,
+                                                              const eosio::checksum256 &fromNode,
+                                                              const eosio::checksum256 &toNode,
+                                                              const std::vector<eosio::name> &edgeNames,
+                                                              const uint32_t maxHops)
+    {
+        TRACE_FUNCTION()
+        EOS_CHECK(!edgeNames.empty(), "a path search needs the edge names to follow");
+        if (fromNode == toNode)
+        {
+            return std::vector<Edge>{};
+        }
+
+        // one end of the search: the edge that first reached each node, and the last level
+        struct Side
+        {
+            EdgeDirection direction;
+            std::map<eosio::checksum256, std::optional<Edge>> reached;
+            std::vector<eosio::checksum256> level;
+            uint32_t depth = 0;
+        };
+
+        Side forward{EdgeDirection::Out, {{fromNode, std::nullopt}}, {fromNode}};
+        Side backward{EdgeDirection::In, {{toNode, std::nullopt}}, {toNode}};
+        std::optional<eosio::checksum256> meeting;
+
+        // the first meeting is on a shortest path, as levels grow by one hop at a time
+        while (!meeting && forward.depth + backward.depth < maxHops && !forward.level.empty() && !backward.level.empty())
+        {
+            Side &side = forward.level.size() <= backward.level.size() ? forward : backward;
+            const Side &other = &side == &forward ? backward : forward;
+
+            std::vector<eosio::checksum256> next;
+            for (const eosio::checksum256 &node : side.level)
+            {
+                for (const eosio::name &edgeName : edgeNames)
+                {
+                    EdgeRange range = side.direction == EdgeDirection::Out ? EdgeRange::from(contract, node, edgeName)
+                                                                           : EdgeRange::to(contract, node, edgeName);
+                    range.visit([&](const EdgeRef &edge) {
+                        const eosio::checksum256 reached = side.direction == EdgeDirection::Out ? edge.getToNode() : edge.getFromNode();
+                        if (!side.reached.emplace(reached, edge.toEdge()).second)
+                        {
+                            return true;
+                        }
+
+                        next.push_back(reached);
+                        if (other.reached.count(reached))
+                        {
+                            meeting = reached;
+                        }
+                        return !meeting;
+                    });
+
+                    if (meeting)
+                    {
+                        break;
+                    }
+                }
+
+                if (meeting)
+                {
+                    break;
+                }
+            }
+
+            side.level = std::move(next);
+            side.depth++;
+        }
+
+        if (!meeting)
+        {
+            return std::nullopt;
+        }
+
+        std::vector<Edge> path;
+        for (auto node = *meeting; forward.reached[node]; node = forward.reached[node]->from_node)
+        {
+            path.push_back(*forward.reached[node]);
+        }
+        std::reverse(path.begin(), path.end());
+
+        for (auto node = *meeting; backward.reached[node]; node = backward.reached[node]->to_node)
+        {
+            path.push_back(*backward.reached[node]);
+        }
+        return path;
+    }
+} // namespace hypha
\ No newline at end of file
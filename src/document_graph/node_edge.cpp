@@ -0,0 +1,56 @@
+#include <document_graph/node_edge.hpp>
+#include <document_graph/util.hpp>
+#include <logger/logger.hpp>
+
+namespace hypha
+{
+    std::optional<uint64_t> DocumentNode::find(const eosio::name &contract, const eosio::checksum256 &hash)
+    {
+        node_table n_t(contract, contract.value);
+        auto hash_index = n_t.get_index<eosio::name("idhash")>();
+        auto itr = hash_index.find(hash);
+        if (itr == hash_index.end())
+        {
+            return std::nullopt;
+        }
+        return itr->id;
+    }
+
+    uint64_t DocumentNode::getOrNew(const eosio::name &contract, const eosio::checksum256 &hash)
+    {
+        if (auto id = find(contract, hash))
+        {
+            return *id;
+        }
+
+        node_table n_t(contract, contract.value);
+        uint64_t id = n_t.available_primary_key();
+        n_t.emplace(contract, [&](auto &n) {
+            n.id = id;
+            n.hash = hash;
+        });
+        return id;
+    }
+
+    eosio::checksum256 DocumentNode::getHash(const eosio::name &contract, uint64_t id)
+    {
+        node_table n_t(contract, contract.value);
+        auto itr = n_t.find(id);
+        EOS_CHECK(itr != n_t.end(), "document node does not exist: " + std::to_string(id));
+        return itr->hash;
+    }
+
+    NodeEdge::node_edge_table::const_iterator NodeEdge::find(const node_edge_table &ne_t, uint64_t fromNode, uint64_t toNode, const eosio::name &edgeName)
+    {
+        auto from_to_index = ne_t.get_index<eosio::name("byfromto")>();
+        const uint128_t key = nodeKey(fromNode, toNode);
+        for (auto itr = from_to_index.find(key); itr != from_to_index.end() && itr->by_from_node_to_node() == key; ++itr)
+        {
+            if (itr->edge_name == edgeName)
+            {
+                return ne_t.iterator_to(*itr);
+            }
+        }
+        return ne_t.end();
+    }
+} // namespace hypha
\ No newline at end of file
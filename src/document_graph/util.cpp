@@ -3,6 +3,8 @@
 
 #include <document_graph/util.hpp>
 
+#include <cstring>
+
 namespace hypha
 {
 
@@ -50,4 +52,56 @@ namespace hypha
         return toUint64(readableHash(sha) + label.to_string());
     }
 
+    namespace
+    {
+        constexpr std::size_t DIGEST_SIZE = 32;
+        constexpr std::size_t NAME_SIZE = sizeof(std::uint64_t);
+
+        char *appendDigest(char *out, const eosio::checksum256 &sha)
+        {
+            auto bytes = sha.extract_as_byte_array();
+            std::memcpy(out, bytes.data(), DIGEST_SIZE);
+            return out + DIGEST_SIZE;
+        }
+
+        char *appendName(char *out, const eosio::name &label)
+        {
+            std::memcpy(out, &label.value, NAME_SIZE);
+            return out + NAME_SIZE;
+        }
+
+        std::uint64_t leadingKey(const char *data, std::size_t size)
+        {
+            auto hbytes = eosio::sha256(data, size).extract_as_byte_array();
+            std::uint64_t key = 0;
+            for (std::size_t i = 0; i < sizeof(key); ++i)
+            {
+                key <<= 8;
+                key |= hbytes[i];
+            }
+            return key;
+        }
+    } // namespace
+
+    const std::uint64_t compositeKey(const eosio::checksum256 &sha1, const eosio::checksum256 &sha2, const eosio::name &label)
+    {
+        char buffer[DIGEST_SIZE * 2 + NAME_SIZE];
+        appendName(appendDigest(appendDigest(buffer, sha1), sha2), label);
+        return leadingKey(buffer, sizeof(buffer));
+    }
+
+    const std::uint64_t compositeKey(const eosio::checksum256 &sha1, const eosio::checksum256 &sha2)
+    {
+        char buffer[DIGEST_SIZE * 2];
+        appendDigest(appendDigest(buffer, sha1), sha2);
+        return leadingKey(buffer, sizeof(buffer));
+    }
+
+    const std::uint64_t compositeKey(const eosio::checksum256 &sha, const eosio::name &label)
+    {
+        char buffer[DIGEST_SIZE + NAME_SIZE];
+        appendName(appendDigest(buffer, sha), label);
+        return leadingKey(buffer, sizeof(buffer));
+    }
+
 } // namespace hypha
\ No newline at end of file